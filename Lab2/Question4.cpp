@@ -1,48 +1,308 @@
 #include <GL/glut.h>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <string>
+#include <thread>
 #include <vector>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 const int WIDTH = 800;
 const int HEIGHT = 600;
 const int MARGIN = 60;
+const size_t MAX_SERIES = 65535;
+
+// Binary series file: SeriesHeader, then float64 x[count], then float64 y[count]
+const char SERIES_MAGIC[8] = {'L', 'G', 'S', 'E', 'R', 'I', 'E', 'S'};
+
+struct SeriesHeader
+{
+    char magic[8];
+    uint64_t count;
+};
+
+// Read-only mapping of a whole file
+struct MappedFile
+{
+    const char *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+};
+
+// Columnar x/y values, pointing either into a file mapping or into xStore/yStore
+struct Series
+{
+    const double *x;
+    const double *y;
+    size_t count;
+};
+
+struct Bounds
+{
+    double minX, maxX, minY, maxY;
+};
 
-struct Point
+// Screen coordinates of every series point, reused until the data or the window changes
+struct ScreenCache
+{
+    std::vector<int> x, y;
+    unsigned dataVersion = 0;
+    int width = 0, height = 0;
+};
+
+struct Vec2
 {
     float x, y;
 };
 
-std::vector<Point> data;
-float minX, maxX, minY, maxY;
+enum JoinStyle
+{
+    JOIN_MITER,
+    JOIN_BEVEL
+};
+
+// One loaded series and whatever backs its columns
+struct SeriesData
+{
+    Series view = {nullptr, nullptr, 0};
+    std::vector<double> xStore, yStore;
+    MappedFile file;
+    ScreenCache screen;
+    uint32_t color = 0;
+};
 
-void drawLineDDA(int x1, int y1, int x2, int y2)
+// RGBA8 pixels, row 0 at the bottom so it can be handed straight to glDrawPixels
+struct Framebuffer
 {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    int steps = (abs(dx) > abs(dy)) ? abs(dx) : abs(dy);
+    int width = 0, height = 0;
+    std::vector<uint32_t> pixels;
+};
 
-    float xInc = dx / steps;
-    float yInc = dy / steps;
-    float x = x1, y = y1;
+// A deque so that appending never moves a series that views already point into
+std::deque<SeriesData> sources;
+double minX, maxX, minY, maxY;
+unsigned dataVersion = 0;
+int windowWidth = WIDTH, windowHeight = HEIGHT;
+float lineWidth = 1.0f;
+JoinStyle joinStyle = JOIN_MITER;
+bool softwareRender = false;
+Framebuffer frame;
+std::vector<std::vector<uint16_t>> coverageLayers;
+std::vector<uint32_t> palette;
 
-    glBegin(GL_POINTS);
-    for (int i = 0; i <= steps; i++)
+// Run fn(0) .. fn(tasks - 1), each on its own thread
+template <typename Fn>
+void runParallel(size_t tasks, Fn fn)
+{
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < tasks; t++)
+        workers.emplace_back(fn, t);
+    fn(0);
+    for (auto &w : workers)
+        w.join();
+}
+
+// DDA walk over the whole polyline: every segment starts at its exact vertex and
+// skips its first step, so each joint is plotted exactly once
+template <typename Plot>
+void rasterizePolyline(const int *xs, const int *ys, size_t n, Plot plot)
+{
+    if (n == 0)
+        return;
+
+    plot(xs[0], ys[0]);
+    for (size_t i = 0; i + 1 < n; i++)
     {
-        glVertex2f(round(x), round(y));
-        x += xInc;
-        y += yInc;
+        int dx = xs[i + 1] - xs[i];
+        int dy = ys[i + 1] - ys[i];
+        int steps = std::max(abs(dx), abs(dy));
+        if (steps == 0)
+            continue;
+
+        float xInc = static_cast<float>(dx) / steps;
+        float yInc = static_cast<float>(dy) / steps;
+        float x = xs[i], y = ys[i];
+        for (int k = 1; k <= steps; k++)
+        {
+            x += xInc;
+            y += yInc;
+            plot(static_cast<int>(round(x)), static_cast<int>(round(y)));
+        }
     }
-    glEnd();
 }
 
-int mapX(float x)
+// Triangulate a thick polyline: one quad per segment and a miter or bevel wedge on
+// the outer side of each joint. Miters longer than MITER_LIMIT half-widths fall back to bevels
+template <typename Tri>
+void strokePolyline(const int *xs, const int *ys, size_t n, float width, JoinStyle join, Tri tri)
 {
-    return MARGIN + ((x - minX) / (maxX - minX)) * (WIDTH - 2 * MARGIN);
+    const float MITER_LIMIT = 4.0f;
+    float hw = width * 0.5f;
+
+    Vec2 prevNormal = {0, 0};
+    bool havePrev = false;
+    for (size_t i = 0; i + 1 < n; i++)
+    {
+        Vec2 a = {static_cast<float>(xs[i]), static_cast<float>(ys[i])};
+        Vec2 b = {static_cast<float>(xs[i + 1]), static_cast<float>(ys[i + 1])};
+        float dx = b.x - a.x, dy = b.y - a.y;
+        float len = sqrt(dx * dx + dy * dy);
+        if (len == 0)
+            continue;
+
+        Vec2 normal = {-dy / len, dx / len};
+        Vec2 off = {normal.x * hw, normal.y * hw};
+
+        tri({a.x + off.x, a.y + off.y}, {a.x - off.x, a.y - off.y}, {b.x - off.x, b.y - off.y});
+        tri({a.x + off.x, a.y + off.y}, {b.x - off.x, b.y - off.y}, {b.x + off.x, b.y + off.y});
+
+        if (havePrev)
+        {
+            // The outer side of the turn is opposite to the turn direction
+            float turn = prevNormal.x * normal.y - prevNormal.y * normal.x;
+            float side = turn > 0 ? -1.0f : 1.0f;
+            Vec2 p0 = {a.x + side * prevNormal.x * hw, a.y + side * prevNormal.y * hw};
+            Vec2 p1 = {a.x + side * off.x, a.y + side * off.y};
+
+            Vec2 mid = {prevNormal.x + normal.x, prevNormal.y + normal.y};
+            float midLen = sqrt(mid.x * mid.x + mid.y * mid.y);
+            float cosHalf = midLen * 0.5f;
+            if (join == JOIN_MITER && midLen > 0 && cosHalf * MITER_LIMIT > 1.0f)
+            {
+                float miter = hw / cosHalf;
+                Vec2 m = {a.x + side * mid.x / midLen * miter, a.y + side * mid.y / midLen * miter};
+                tri(a, p0, m);
+                tri(a, m, p1);
+            }
+            else if (turn != 0)
+            {
+                tri(a, p0, p1);
+            }
+        }
+        prevNormal = normal;
+        havePrev = true;
+    }
 }
 
-int mapY(float y)
+// Fill a triangle into a width x height pixel grid, sampling at pixel centres
+template <typename Plot>
+void fillTriangle(Vec2 a, Vec2 b, Vec2 c, int width, int height, Plot plot)
 {
-    return MARGIN + ((y - minY) / (maxY - minY)) * (HEIGHT - 2 * MARGIN);
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (area == 0)
+        return;
+    if (area < 0)
+        std::swap(b, c);
+
+    int x0 = std::max(0, static_cast<int>(floor(std::min({a.x, b.x, c.x}))));
+    int x1 = std::min(width - 1, static_cast<int>(ceil(std::max({a.x, b.x, c.x}))));
+    int y0 = std::max(0, static_cast<int>(floor(std::min({a.y, b.y, c.y}))));
+    int y1 = std::min(height - 1, static_cast<int>(ceil(std::max({a.y, b.y, c.y}))));
+
+    for (int y = y0; y <= y1; y++)
+    {
+        float py = y + 0.5f;
+        for (int x = x0; x <= x1; x++)
+        {
+            float px = x + 0.5f;
+            if ((b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x) >= 0 &&
+                (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x) >= 0 &&
+                (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x) >= 0)
+                plot(x, y);
+        }
+    }
+}
+
+uint32_t packColor(float r, float g, float b)
+{
+    return static_cast<uint32_t>(r * 255) | static_cast<uint32_t>(g * 255) << 8 |
+           static_cast<uint32_t>(b * 255) << 16 | 0xFF000000u;
+}
+
+void setPixel(Framebuffer &fb, int x, int y, uint32_t color)
+{
+    if (x >= 0 && y >= 0 && x < fb.width && y < fb.height)
+        fb.pixels[static_cast<size_t>(y) * fb.width + x] = color;
+}
+
+// out[i] = int(in[i] * scale + offset), truncating like the old per-point mapX/mapY. With FMA
+// the tail rounds once too, so a point maps to the same pixel whichever loop handles it
+void mapColumn(const double *in, int *out, size_t n, double scale, double offset)
+{
+    size_t i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256d s = _mm256_set1_pd(scale);
+    __m256d o = _mm256_set1_pd(offset);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d v = _mm256_fmadd_pd(_mm256_loadu_pd(in + i), s, o);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm256_cvttpd_epi32(v));
+    }
+    for (; i < n; i++)
+        out[i] = static_cast<int>(std::fma(in[i], scale, offset));
+#else
+    for (; i < n; i++)
+        out[i] = static_cast<int>(in[i] * scale + offset);
+#endif
+}
+
+// Map the whole series into the plot area; the division is done once per axis, not per point
+void updateScreenCache(SeriesData &sd)
+{
+    const Series &series = sd.view;
+    ScreenCache &screen = sd.screen;
+    const size_t MIN_CHUNK = 1 << 16;
+
+    if (screen.dataVersion == dataVersion && screen.width == windowWidth && screen.height == windowHeight)
+        return;
+
+    double scaleX = (windowWidth - 2 * MARGIN) / (maxX - minX);
+    double scaleY = (windowHeight - 2 * MARGIN) / (maxY - minY);
+    double offsetX = MARGIN - minX * scaleX;
+    double offsetY = MARGIN - minY * scaleY;
+
+    screen.x.resize(series.count);
+    screen.y.resize(series.count);
+
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min(threads, series.count / MIN_CHUNK));
+    size_t chunk = (series.count + threads - 1) / threads;
+    runParallel(threads, [&](size_t t)
+                {
+                    size_t begin = std::min(series.count, t * chunk);
+                    size_t n = std::min(series.count, begin + chunk) - begin;
+                    mapColumn(series.x + begin, screen.x.data() + begin, n, scaleX, offsetX);
+                    mapColumn(series.y + begin, screen.y.data() + begin, n, scaleY, offsetY); });
+
+    screen.dataVersion = dataVersion;
+    screen.width = windowWidth;
+    screen.height = windowHeight;
 }
 
 void drawAxes()
@@ -52,41 +312,201 @@ void drawAxes()
 
     glBegin(GL_LINES);
     glVertex2i(MARGIN, MARGIN);
-    glVertex2i(WIDTH - MARGIN, MARGIN);
+    glVertex2i(windowWidth - MARGIN, MARGIN);
     glVertex2i(MARGIN, MARGIN);
-    glVertex2i(MARGIN, HEIGHT - MARGIN);
+    glVertex2i(MARGIN, windowHeight - MARGIN);
     glEnd();
 }
 
 void drawGraph()
 {
-    glColor3f(0.0, 1.0, 0.0);
-    glPointSize(2.0);
+    const Series &series = sources[0].view;
+    updateScreenCache(sources[0]);
+    const ScreenCache &screen = sources[0].screen;
+    const int *sx = screen.x.data();
+    const int *sy = screen.y.data();
 
-    for (size_t i = 0; i < data.size() - 1; i++)
+    glColor3f(0.0, 1.0, 0.0);
+    if (lineWidth <= 1.0f)
+    {
+        glPointSize(2.0);
+        glBegin(GL_POINTS);
+        rasterizePolyline(sx, sy, series.count, [](int x, int y)
+                          { glVertex2i(x, y); });
+        glEnd();
+    }
+    else
     {
-        int x1 = mapX(data[i].x);
-        int y1 = mapY(data[i].y);
-        int x2 = mapX(data[i + 1].x);
-        int y2 = mapY(data[i + 1].y);
-        drawLineDDA(x1, y1, x2, y2);
+        glBegin(GL_TRIANGLES);
+        strokePolyline(sx, sy, series.count, lineWidth, joinStyle, [](Vec2 a, Vec2 b, Vec2 c)
+                       {
+                           glVertex2f(a.x, a.y);
+                           glVertex2f(b.x, b.y);
+                           glVertex2f(c.x, c.y); });
+        glEnd();
     }
 
     glColor3f(1.0, 0.0, 0.0);
     glPointSize(8.0);
     glBegin(GL_POINTS);
-    for (size_t i = 0; i < data.size(); i++)
+    for (size_t i = 0; i < series.count; i++)
     {
-        glVertex2i(mapX(data[i].x), mapY(data[i].y));
+        glVertex2i(sx[i], sy[i]);
     }
     glEnd();
 }
 
+// Same graph rasterized on the CPU into frame, then copied to the window in one call
+void drawGraphSoftware()
+{
+    const Series &series = sources[0].view;
+    updateScreenCache(sources[0]);
+    const ScreenCache &screen = sources[0].screen;
+    const int *sx = screen.x.data();
+    const int *sy = screen.y.data();
+
+    frame.width = windowWidth;
+    frame.height = windowHeight;
+    frame.pixels.assign(static_cast<size_t>(frame.width) * frame.height, 0);
+
+    uint32_t green = packColor(0.0f, 1.0f, 0.0f);
+    if (lineWidth <= 1.0f)
+    {
+        rasterizePolyline(sx, sy, series.count, [green](int x, int y)
+                          {
+                              setPixel(frame, x, y, green);
+                              setPixel(frame, x + 1, y, green);
+                              setPixel(frame, x, y + 1, green);
+                              setPixel(frame, x + 1, y + 1, green); });
+    }
+    else
+    {
+        strokePolyline(sx, sy, series.count, lineWidth, joinStyle, [green](Vec2 a, Vec2 b, Vec2 c)
+                       { fillTriangle(a, b, c, frame.width, frame.height, [green](int x, int y)
+                                      { frame.pixels[static_cast<size_t>(y) * frame.width + x] = green; }); });
+    }
+
+    uint32_t red = packColor(1.0f, 0.0f, 0.0f);
+    for (size_t i = 0; i < series.count; i++)
+    {
+        for (int dy = -4; dy < 4; dy++)
+            for (int dx = -4; dx < 4; dx++)
+                setPixel(frame, sx[i] + dx, sy[i] + dy, red);
+    }
+
+    glRasterPos2i(0, 0);
+    glDrawPixels(frame.width, frame.height, GL_RGBA, GL_UNSIGNED_BYTE, frame.pixels.data());
+}
+
+// Per pixel, keep the highest series id found in any layer and replace it by its colour.
+// The work is (pixels x layers) with one layer per thread, independent of the series count
+void compositeLayers(size_t layerCount, size_t threads)
+{
+    size_t n = frame.pixels.size();
+    size_t chunk = (n + threads - 1) / threads;
+
+    runParallel(threads, [&](size_t t)
+                {
+                    size_t begin = std::min(n, t * chunk);
+                    size_t end = std::min(n, begin + chunk);
+                    uint16_t *top = coverageLayers[0].data();
+                    for (size_t l = 1; l < layerCount; l++)
+                    {
+                        const uint16_t *src = coverageLayers[l].data();
+                        size_t i = begin;
+#ifdef __AVX2__
+                        for (; i + 16 <= end; i += 16)
+                        {
+                            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(top + i));
+                            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+                            _mm256_storeu_si256(reinterpret_cast<__m256i *>(top + i), _mm256_max_epu16(a, b));
+                        }
+#endif
+                        for (; i < end; i++)
+                            top[i] = std::max(top[i], src[i]);
+                    }
+
+                    uint32_t *out = frame.pixels.data();
+                    size_t i = begin;
+#ifdef __AVX2__
+                    const int *colors = reinterpret_cast<const int *>(palette.data());
+                    for (; i + 8 <= end; i += 8)
+                    {
+                        __m256i ids = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(top + i)));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_i32gather_epi32(colors, ids, 4));
+                    }
+#endif
+                    for (; i < end; i++)
+                        out[i] = palette[top[i]]; });
+}
+
+// Every thread rasterizes a contiguous, ascending range of series into its own layer of
+// series ids, so later series win inside a layer and the layer maximum restores series order
+void drawMultiSeries()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    frame.width = windowWidth;
+    frame.height = windowHeight;
+    size_t n = static_cast<size_t>(frame.width) * frame.height;
+    frame.pixels.resize(n);
+
+    size_t count = sources.size();
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, count);
+    size_t chunk = (count + threads - 1) / threads;
+    threads = (count + chunk - 1) / chunk;
+    if (coverageLayers.size() < threads)
+        coverageLayers.resize(threads);
+
+    runParallel(threads, [&](size_t t)
+                {
+                    std::vector<uint16_t> &layer = coverageLayers[t];
+                    layer.assign(n, 0);
+                    int w = frame.width, h = frame.height;
+
+                    for (size_t k = t * chunk; k < std::min(count, (t + 1) * chunk); k++)
+                    {
+                        SeriesData &sd = sources[k];
+                        updateScreenCache(sd);
+                        uint16_t id = static_cast<uint16_t>(k + 1);
+                        const int *sx = sd.screen.x.data();
+                        const int *sy = sd.screen.y.data();
+
+                        if (lineWidth <= 1.0f)
+                        {
+                            rasterizePolyline(sx, sy, sd.view.count, [&](int x, int y)
+                                              {
+                                                  if (x >= 0 && y >= 0 && x < w && y < h)
+                                                      layer[static_cast<size_t>(y) * w + x] = id; });
+                        }
+                        else
+                        {
+                            strokePolyline(sx, sy, sd.view.count, lineWidth, joinStyle, [&](Vec2 a, Vec2 b, Vec2 c)
+                                           { fillTriangle(a, b, c, w, h, [&](int x, int y)
+                                                          { layer[static_cast<size_t>(y) * w + x] = id; }); });
+                        }
+                    } });
+
+    compositeLayers(threads, std::max(1u, std::thread::hardware_concurrency()));
+
+    glRasterPos2i(0, 0);
+    glDrawPixels(frame.width, frame.height, GL_RGBA, GL_UNSIGNED_BYTE, frame.pixels.data());
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Rendered " << count << " series on " << threads << " threads in " << ms << " ms\n";
+}
+
 void display()
 {
     glClear(GL_COLOR_BUFFER_BIT);
+    if (sources.size() > 1)
+        drawMultiSeries();
+    else if (softwareRender)
+        drawGraphSoftware();
     drawAxes();
-    drawGraph();
+    if (sources.size() == 1 && !softwareRender)
+        drawGraph();
     glFlush();
 }
 
@@ -98,51 +518,563 @@ void init()
     gluOrtho2D(0, WIDTH, 0, HEIGHT);
 }
 
+void reshape(int width, int height)
+{
+    windowWidth = width;
+    windowHeight = height;
+    glViewport(0, 0, width, height);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluOrtho2D(0, width, 0, height);
+}
+
 void keyboard(unsigned char key, int x, int y)
 {
-    if (key == 27)
+    switch (key)
+    {
+    case '+':
+        lineWidth += 1.0f;
+        std::cout << "Line width: " << lineWidth << "\n";
+        break;
+    case '-':
+        lineWidth = std::max(1.0f, lineWidth - 1.0f);
+        std::cout << "Line width: " << lineWidth << "\n";
+        break;
+    case 'j':
+        joinStyle = joinStyle == JOIN_MITER ? JOIN_BEVEL : JOIN_MITER;
+        std::cout << "Joins: " << (joinStyle == JOIN_MITER ? "miter" : "bevel") << "\n";
+        break;
+    case 'f':
+        softwareRender = !softwareRender;
+        std::cout << "Renderer: " << (softwareRender ? "software framebuffer" : "OpenGL") << "\n";
+        break;
+    case 27:
         exit(0);
+    }
+    glutPostRedisplay();
+}
+
+// Map a file read-only; the pages are loaded lazily by the OS on first touch
+bool mapFile(const char *path, MappedFile &mf)
+{
+#ifdef _WIN32
+    mf.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                          FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (mf.file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mf.file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(mf.file);
+        mf.file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    mf.mapping = CreateFileMappingA(mf.file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mf.mapping == NULL)
+    {
+        CloseHandle(mf.file);
+        mf.file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    mf.data = static_cast<const char *>(MapViewOfFile(mf.mapping, FILE_MAP_READ, 0, 0, 0));
+    if (mf.data == nullptr)
+    {
+        CloseHandle(mf.mapping);
+        CloseHandle(mf.file);
+        mf.mapping = NULL;
+        mf.file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    mf.size = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return false;
+
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    mf.data = static_cast<const char *>(p);
+    mf.size = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void unmapFile(MappedFile &mf)
+{
+    if (mf.data == nullptr)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(mf.data);
+    CloseHandle(mf.mapping);
+    CloseHandle(mf.file);
+    mf.mapping = NULL;
+    mf.file = INVALID_HANDLE_VALUE;
+#else
+    munmap(const_cast<char *>(mf.data), mf.size);
+#endif
+    mf.data = nullptr;
+    mf.size = 0;
+}
+
+// Point the series at the x[] and y[] columns inside a mapped binary file
+bool loadBinarySeries(const char *path, SeriesData &sd)
+{
+    MappedFile &seriesFile = sd.file;
+    Series &series = sd.view;
+
+    if (!mapFile(path, seriesFile))
+    {
+        std::cerr << "Cannot open " << path << "\n";
+        return false;
+    }
+
+    SeriesHeader header;
+    size_t payload = seriesFile.size >= sizeof(header) ? seriesFile.size - sizeof(header) : 0;
+    if (payload > 0)
+        memcpy(&header, seriesFile.data, sizeof(header));
+
+    if (payload == 0 || memcmp(header.magic, SERIES_MAGIC, sizeof(SERIES_MAGIC)) != 0 ||
+        header.count == 0 || header.count > payload / (2 * sizeof(double)))
+    {
+        std::cerr << path << " is not a valid series file\n";
+        unmapFile(seriesFile);
+        return false;
+    }
+
+    // The header is 16 bytes, so both columns stay 8-byte aligned in the page-aligned mapping
+    series.x = reinterpret_cast<const double *>(seriesFile.data + sizeof(header));
+    series.y = series.x + header.count;
+    series.count = static_cast<size_t>(header.count);
+
+    std::cout << "Mapped " << series.count << " points from " << path << "\n";
+    return true;
+}
+
+void loadDefaultSeries(SeriesData &sd)
+{
+    sd.xStore = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    sd.yStore = {45, 52, 48, 65, 58, 73, 81, 76, 88, 95};
+
+    sd.view.x = sd.xStore.data();
+    sd.view.y = sd.yStore.data();
+    sd.view.count = sd.xStore.size();
+}
+
+// Random walks for exercising the multi-series renderer
+void generateDemoSeries(size_t seriesCount, size_t points)
+{
+    uint32_t state = 12345;
+    for (size_t k = 0; k < seriesCount; k++)
+    {
+        SeriesData &sd = sources.emplace_back();
+        sd.xStore.resize(points);
+        sd.yStore.resize(points);
+
+        double y = static_cast<double>(k);
+        for (size_t i = 0; i < points; i++)
+        {
+            state = state * 1664525u + 1013904223u;
+            y += (static_cast<double>(state >> 8) / (1 << 24) - 0.5);
+            sd.xStore[i] = static_cast<double>(i);
+            sd.yStore[i] = y;
+        }
+
+        sd.view.x = sd.xStore.data();
+        sd.view.y = sd.yStore.data();
+        sd.view.count = points;
+    }
+}
+
+const char *skipBlanks(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    return p;
+}
+
+// Parse "x,y" rows in [begin, end); rows that do not start with two numbers (e.g. a header) are skipped
+void parseCsvChunk(const char *begin, const char *end, std::vector<double> &xs, std::vector<double> &ys)
+{
+    const char *p = begin;
+    while (p < end)
+    {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (eol == nullptr)
+            eol = end;
+
+        double x, y;
+        auto rx = std::from_chars(skipBlanks(p, eol), eol, x);
+        if (rx.ec == std::errc())
+        {
+            const char *q = skipBlanks(rx.ptr, eol);
+            if (q < eol && (*q == ',' || *q == ';'))
+                q++;
+            auto ry = std::from_chars(skipBlanks(q, eol), eol, y);
+            if (ry.ec == std::errc())
+            {
+                xs.push_back(x);
+                ys.push_back(y);
+            }
+        }
+        p = eol + 1;
+    }
+}
+
+// Parse data[0 .. size) in threads chunks split at newlines, merged into xStore/yStore in file order
+void parseCsvParallel(const char *data, size_t size, size_t threads, std::vector<double> &xStore,
+                      std::vector<double> &yStore)
+{
+    // Chunk t covers [cuts[t], cuts[t + 1]); every cut except the ends sits just after a newline
+    std::vector<const char *> cuts(threads + 1);
+    const char *end = data + size;
+    cuts[0] = data;
+    cuts[threads] = end;
+    for (size_t t = 1; t < threads; t++)
+    {
+        const char *p = std::max(cuts[t - 1], data + size * t / threads);
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        cuts[t] = eol ? eol + 1 : end;
+    }
+
+    std::vector<std::vector<double>> xs(threads), ys(threads);
+    runParallel(threads, [&](size_t t)
+                {
+                    size_t estimate = (cuts[t + 1] - cuts[t]) / 16;
+                    xs[t].reserve(estimate);
+                    ys[t].reserve(estimate);
+                    parseCsvChunk(cuts[t], cuts[t + 1], xs[t], ys[t]); });
+
+    // Prefix sums give each chunk its slot, so the copies need no locking
+    std::vector<size_t> offsets(threads + 1, 0);
+    for (size_t t = 0; t < threads; t++)
+        offsets[t + 1] = offsets[t] + xs[t].size();
+
+    xStore.resize(offsets[threads]);
+    yStore.resize(offsets[threads]);
+    runParallel(threads, [&](size_t t)
+                {
+                    std::copy(xs[t].begin(), xs[t].end(), xStore.begin() + offsets[t]);
+                    std::copy(ys[t].begin(), ys[t].end(), yStore.begin() + offsets[t]); });
+}
+
+// Parse a mapped CSV file in parallel into sd.xStore/sd.yStore
+bool loadCsvSeries(const char *path, SeriesData &sd)
+{
+    std::vector<double> &xStore = sd.xStore;
+    std::vector<double> &yStore = sd.yStore;
+    Series &series = sd.view;
+
+    const size_t MIN_CHUNK = 1 << 20;
+
+    MappedFile csv;
+    if (!mapFile(path, csv))
+    {
+        std::cerr << "Cannot open " << path << "\n";
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min(threads, csv.size / MIN_CHUNK));
+    parseCsvParallel(csv.data, csv.size, threads, xStore, yStore);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = csv.size / (1024.0 * 1024.0);
+    unmapFile(csv);
+
+    if (xStore.empty())
+    {
+        std::cerr << path << " contains no x,y rows\n";
+        return false;
+    }
+
+    series.x = xStore.data();
+    series.y = yStore.data();
+    series.count = xStore.size();
+
+    std::cout << "Parsed " << series.count << " rows from " << path << " ("
+              << megabytes << " MB in " << seconds * 1000.0 << " ms, "
+              << megabytes / std::max(seconds, 1e-9) << " MB/s, " << threads << " threads)\n";
+    return true;
+}
+
+// Check parseCsvParallel against a single parseCsvChunk over the same buffer, for several
+// thread counts: rows of mixed formats with and without a trailing newline, fixed-width rows
+// whose chunk splits land exactly on line boundaries, and fewer rows than threads. Then time
+// both on a large buffer
+void benchmarkCsvParser()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    auto mixedRows = [](size_t rows)
+    {
+        std::string text = "x,y\n";
+        char row[64];
+        uint32_t state = 7;
+        for (size_t i = 0; i < rows; i++)
+        {
+            state = state * 1664525u + 1013904223u;
+            double y = (static_cast<double>(state >> 8) / (1 << 24) - 0.5) * 1e4;
+            switch (i % 4)
+            {
+            case 0:
+                snprintf(row, sizeof(row), "%zu,%.17g\n", i, y);
+                break;
+            case 1:
+                snprintf(row, sizeof(row), " %zu ; %g\n", i, y);
+                break;
+            case 2:
+                snprintf(row, sizeof(row), "%zu.5,\t%e\n", i, y);
+                break;
+            default:
+                snprintf(row, sizeof(row), "%zu,%.3f\n", i, y);
+                break;
+            }
+            text += row;
+        }
+        return text;
+    };
+    auto fixedRows = [](size_t rows)
+    {
+        std::string text;
+        char row[32];
+        for (size_t i = 0; i < rows; i++)
+        {
+            snprintf(row, sizeof(row), "%07zu,%07zu\n", i, rows - i); // 16 bytes a row
+            text += row;
+        }
+        return text;
+    };
+
+    std::string mixed = mixedRows(10007), fixed = fixedRows(4 * 3 * 5 * 7 * 16);
+    std::vector<std::string> cases = {mixed, mixed.substr(0, mixed.size() - 1), fixed,
+                                      fixed.substr(0, fixed.size() - 1), "1,2\n3,4", "", "\n\n\n"};
+
+    bool same = true;
+    size_t checks = 0;
+    for (const std::string &text : cases)
+    {
+        std::vector<double> xs, ys;
+        parseCsvChunk(text.data(), text.data() + text.size(), xs, ys);
+        for (size_t threads : {1, 2, 3, 4, 5, 7, 8, 16, 64})
+        {
+            std::vector<double> px, py;
+            parseCsvParallel(text.data(), text.size(), threads, px, py);
+            checks++;
+            if (px != xs || py != ys)
+            {
+                std::cout << "  Mismatch: " << text.size() << " bytes, " << threads << " threads, "
+                          << px.size() << " rows instead of " << xs.size() << "\n";
+                same = false;
+            }
+        }
+    }
+    std::cout << "CSV parser: " << checks << " parallel parses checked against a single-threaded one, "
+              << (same ? "all match" : "MISMATCH") << "\n";
+
+    std::string big = mixedRows(4000000);
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<double> xs, ys, px, py;
+    auto t0 = Clock::now();
+    parseCsvChunk(big.data(), big.data() + big.size(), xs, ys);
+    auto t1 = Clock::now();
+    parseCsvParallel(big.data(), big.size(), threads, px, py);
+    auto t2 = Clock::now();
+
+    double megabytes = big.size() / (1024.0 * 1024.0);
+    std::cout << "  " << megabytes << " MB, " << xs.size() << " rows: single thread "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms, " << threads << " threads "
+              << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms, "
+              << (px == xs && py == ys ? "same rows" : "ROWS DIFFER") << "\n";
+}
+
+bool hasExtension(const char *path, const char *ext)
+{
+    size_t n = strlen(path), m = strlen(ext);
+    if (n < m)
+        return false;
+    for (size_t i = 0; i < m; i++)
+    {
+        if (tolower(static_cast<unsigned char>(path[n - m + i])) != ext[i])
+            return false;
+    }
+    return true;
+}
+
+Bounds scanBounds(const Series &s, size_t begin, size_t end)
+{
+    Bounds b = {s.x[begin], s.x[begin], s.y[begin], s.y[begin]};
+
+    for (size_t i = begin + 1; i < end; i++)
+    {
+        if (s.x[i] < b.minX)
+            b.minX = s.x[i];
+        if (s.x[i] > b.maxX)
+            b.maxX = s.x[i];
+        if (s.y[i] < b.minY)
+            b.minY = s.y[i];
+        if (s.y[i] > b.maxY)
+            b.maxY = s.y[i];
+    }
+    return b;
+}
+
+// Min/max of the series, scanned in parallel chunks for large inputs
+Bounds computeBounds(const Series &s)
+{
+    const size_t MIN_CHUNK = 1 << 16;
+
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, (s.count + MIN_CHUNK - 1) / MIN_CHUNK);
+    if (threads <= 1)
+        return scanBounds(s, 0, s.count);
+
+    size_t chunk = (s.count + threads - 1) / threads;
+    threads = (s.count + chunk - 1) / chunk;
+
+    std::vector<Bounds> partial(threads);
+    runParallel(threads, [&](size_t t)
+                {
+                    size_t begin = t * chunk;
+                    size_t end = std::min(s.count, begin + chunk);
+                    partial[t] = scanBounds(s, begin, end); });
+
+    Bounds b = partial[0];
+    for (size_t t = 1; t < threads; t++)
+    {
+        b.minX = std::min(b.minX, partial[t].minX);
+        b.maxX = std::max(b.maxX, partial[t].maxX);
+        b.minY = std::min(b.minY, partial[t].minY);
+        b.maxY = std::max(b.maxY, partial[t].maxY);
+    }
+    return b;
 }
 
-void loadData()
+uint32_t seriesColor(size_t k)
 {
-    data.push_back({1, 45});
-    data.push_back({2, 52});
-    data.push_back({3, 48});
-    data.push_back({4, 65});
-    data.push_back({5, 58});
-    data.push_back({6, 73});
-    data.push_back({7, 81});
-    data.push_back({8, 76});
-    data.push_back({9, 88});
-    data.push_back({10, 95});
+    if (k == 0)
+        return packColor(0.0f, 1.0f, 0.0f);
 
-    minX = maxX = data[0].x;
-    minY = maxY = data[0].y;
+    // Golden-ratio hue steps keep neighbouring series distinguishable
+    float h = fmod(0.33f + k * 0.618034f, 1.0f) * 6.0f;
+    float f = h - floor(h);
+    switch (static_cast<int>(h))
+    {
+    case 0:
+        return packColor(1.0f, f, 0.2f);
+    case 1:
+        return packColor(1.0f - f, 1.0f, 0.2f);
+    case 2:
+        return packColor(0.2f, 1.0f, f);
+    case 3:
+        return packColor(0.2f, 1.0f - f, 1.0f);
+    case 4:
+        return packColor(f, 0.2f, 1.0f);
+    default:
+        return packColor(1.0f, 0.2f, 1.0f - f);
+    }
+}
 
-    for (size_t i = 1; i < data.size(); i++)
+// Each argument is a .csv or binary series file; "--demo-series N" adds N random walks
+void loadData(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
     {
-        if (data[i].x < minX)
-            minX = data[i].x;
-        if (data[i].x > maxX)
-            maxX = data[i].x;
-        if (data[i].y < minY)
-            minY = data[i].y;
-        if (data[i].y > maxY)
-            maxY = data[i].y;
+        if (strcmp(argv[i], "--demo-series") == 0 && i + 1 < argc)
+        {
+            generateDemoSeries(strtoul(argv[++i], nullptr, 10), 1000);
+            continue;
+        }
+
+        SeriesData &sd = sources.emplace_back();
+        bool loaded = hasExtension(argv[i], ".csv") ? loadCsvSeries(argv[i], sd) : loadBinarySeries(argv[i], sd);
+        if (!loaded)
+            sources.pop_back();
     }
+    if (sources.empty())
+        loadDefaultSeries(sources.emplace_back());
 
-    float xPad = (maxX - minX) * 0.1;
-    float yPad = (maxY - minY) * 0.1;
+    // Ids in the coverage layers are 16-bit, with 0 meaning empty
+    if (sources.size() > MAX_SERIES)
+    {
+        std::cerr << "Only the first " << MAX_SERIES << " series are drawn\n";
+        sources.resize(MAX_SERIES);
+    }
+
+    palette.assign(1, 0);
+    for (size_t k = 0; k < sources.size(); k++)
+    {
+        sources[k].color = seriesColor(k);
+        palette.push_back(sources[k].color);
+    }
+
+    Bounds b = computeBounds(sources[0].view);
+    for (size_t k = 1; k < sources.size(); k++)
+    {
+        Bounds sb = computeBounds(sources[k].view);
+        b.minX = std::min(b.minX, sb.minX);
+        b.maxX = std::max(b.maxX, sb.maxX);
+        b.minY = std::min(b.minY, sb.minY);
+        b.maxY = std::max(b.maxY, sb.maxY);
+    }
+    minX = b.minX;
+    maxX = b.maxX;
+    minY = b.minY;
+    maxY = b.maxY;
+
+    double xPad = (maxX - minX) * 0.1;
+    double yPad = (maxY - minY) * 0.1;
+    if (xPad == 0)
+        xPad = 1;
+    if (yPad == 0)
+        yPad = 1;
     minX -= xPad;
     maxX += xPad;
     minY -= yPad;
     maxY += yPad;
+    dataVersion++;
+}
+
+// glutMainLoop never returns, so the mapped files are released when exit() runs
+void unmapSources()
+{
+    for (auto &sd : sources)
+        unmapFile(sd.file);
 }
 
 int main(int argc, char **argv)
 {
-    loadData();
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        benchmarkCsvParser();
+        return 0;
+    }
+
+    loadData(argc, argv);
+    atexit(unmapSources);
+    if (sources.size() > 1)
+        std::cout << sources.size() << " series, drawn with the multi-series renderer\n";
+
+    std::cout << "Controls:\n";
+    std::cout << "  +/-  Line width\n";
+    std::cout << "  j    Toggle miter/bevel joins\n";
+    std::cout << "  f    Toggle OpenGL/software framebuffer\n";
+    std::cout << "  ESC  Exit\n";
 
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
@@ -152,8 +1084,8 @@ int main(int argc, char **argv)
 
     init();
     glutDisplayFunc(display);
+    glutReshapeFunc(reshape);
     glutKeyboardFunc(keyboard);
     glutMainLoop();
-
     return 0;
-}
\ No newline at end of file
+}
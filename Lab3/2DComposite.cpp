@@ -1,6 +1,13 @@
 #include <GL/glut.h>
 #include <iostream>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "Transform2D.h"
+#include "Background2D.h"
+#include "Instances2D.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -26,76 +33,6 @@ void Identity(Matrix3x3 M)
     }
 }
 
-// Draw coordinate axes with grid
-void drawGrid()
-{
-    glColor3f(0.2f, 0.2f, 0.2f);
-    glBegin(GL_LINES);
-
-    for (float i = -1.0f; i <= 1.0f; i += 0.1f)
-    {
-        // Vertical lines
-        glVertex2f(i, -1.0f);
-        glVertex2f(i, 1.0f);
-        // Horizontal lines
-        glVertex2f(-1.0f, i);
-        glVertex2f(1.0f, i);
-    }
-
-    glEnd();
-}
-
-void drawAxes()
-{
-    glLineWidth(3.0f);
-    glColor3f(0.5f, 0.5f, 0.5f);
-
-    // X-axis
-    glBegin(GL_LINES);
-    glVertex2f(-1.0f, 0.0f);
-    glVertex2f(1.0f, 0.0f);
-    glEnd();
-
-    // X-axis arrow
-    glBegin(GL_TRIANGLES);
-    glVertex2f(1.0f, 0.0f);
-    glVertex2f(0.95f, 0.02f);
-    glVertex2f(0.95f, -0.02f);
-    glEnd();
-
-    // Y-axis
-    glBegin(GL_LINES);
-    glVertex2f(0.0f, -1.0f);
-    glVertex2f(0.0f, 1.0f);
-    glEnd();
-
-    // Y-axis arrow
-    glBegin(GL_TRIANGLES);
-    glVertex2f(0.0f, 1.0f);
-    glVertex2f(0.02f, 0.95f);
-    glVertex2f(-0.02f, 0.95f);
-    glEnd();
-
-    glLineWidth(1.0f);
-}
-
-void drawAxisLabels()
-{
-    glColor3f(1.0f, 1.0f, 1.0f);
-
-    // X label
-    glRasterPos2f(0.92f, -0.08f);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, 'X');
-
-    // Y label
-    glRasterPos2f(0.03f, 0.92f);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, 'Y');
-
-    // Origin label
-    glRasterPos2f(0.02f, -0.05f);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, 'O');
-}
-
 // Draw a filled triangle
 void drawTriangle(Point p1, Point p2, Point p3)
 {
@@ -131,6 +68,12 @@ Point transformPoint(Point p, Matrix3x3 M)
     return result;
 }
 
+// Transform a point by an affine transform of any kind
+constexpr Point transformPoint(Point p, const Affine2D &M)
+{
+    return M.apply(p);
+}
+
 // Translation matrix
 void translate(Matrix3x3 T, float tx, float ty)
 {
@@ -147,14 +90,16 @@ void scale(Matrix3x3 S, float scaleX, float scaleY)
     S[1][1] = scaleY;
 }
 
-// Rotation matrix
+// Rotation matrix, sine and cosine computed once
 void rotate(Matrix3x3 R, float theta)
 {
+    float s, c;
+    sinCos(theta, s, c);
     Identity(R);
-    R[0][0] = cos(theta);
-    R[0][1] = -sin(theta);
-    R[1][0] = sin(theta);
-    R[1][1] = cos(theta);
+    R[0][0] = c;
+    R[0][1] = -s;
+    R[1][0] = s;
+    R[1][1] = c;
 }
 
 // Shearing matrix
@@ -186,12 +131,123 @@ void matrixMultiply(Matrix3x3 A, Matrix3x3 B, Matrix3x3 result)
 }
 
 // Calculate centroid of triangle
-Point getCentroid(Point p1, Point p2, Point p3)
+constexpr Point getCentroid(Point p1, Point p2, Point p3)
 {
-    Point centroid;
-    centroid.x = (p1.x + p2.x + p3.x) / 3.0f;
-    centroid.y = (p1.y + p2.y + p3.y) / 3.0f;
-    return centroid;
+    return {(p1.x + p2.x + p3.x) / 3.0f, (p1.y + p2.y + p3.y) / 3.0f};
+}
+
+// Define original triangle in NDC coordinates - CENTER
+constexpr Point triangle[3] = {
+    {-0.08f, -0.1f}, // Bottom-left
+    {-0.08f, 0.05f}, // Top-left
+    {0.05f, -0.1f}}; // Bottom-right
+
+constexpr Point triangleCentroid = getCentroid(triangle[0], triangle[1], triangle[2]);
+
+// Adjustable parameters of the steps
+float rotationDegrees = 45.0f;
+float scaleFactor = 1.3f;
+float shearX = 0.8f;
+
+// Each step is a scene node on top of the previous one:
+//   step 1: T1
+//   step 2: T2 * T_back * R * T_to_origin * [step 1]  (about the step 1 centroid)
+//   step 3: T3 * T_back2 * S * T_to_origin2 * [step 2] (about the step 2 centroid)
+//   step 4: T4 * Sh * [step 3]
+SceneGraph2D scene;
+int stepNodes[4];
+Point stepPoints[4][3];
+unsigned stepPointsVersion[4] = {0, 0, 0, 0};
+
+// Instance field: many copies of the triangle drawn as one batch (or on the CPU)
+TriangleInstances instances;
+size_t instanceCount = 100000;
+bool showInstances = false;
+bool cpuInstances = false;
+Framebuffer2D instanceFrame;
+int windowWidth = 800;
+int windowHeight = 600;
+
+void initScene()
+{
+    constexpr Translate2D T1 = Affine2D::translate(-0.65f, 0.0f);
+    constexpr Translate2D T2 = Affine2D::translate(0.65f, 0.62f);
+    constexpr Translate2D T3 = Affine2D::translate(0.18f, -0.62f);
+    constexpr Translate2D T4 = Affine2D::translate(-0.18f, -0.65f);
+    constexpr Vec2f pivot = {triangleCentroid.x, triangleCentroid.y};
+
+    stepNodes[0] = scene.add(-1, Affine2D::identity(), T1);
+    stepNodes[1] = scene.add(stepNodes[0], Affine2D::rotateConst(45.0 * M_PI / 180.0), T2, true, pivot);
+    stepNodes[2] = scene.add(stepNodes[1], Affine2D::scale(scaleFactor, scaleFactor), T3, true, pivot);
+    stepNodes[3] = scene.add(stepNodes[2], Affine2D::shear(shearX, 0.0f), T4);
+}
+
+// Re-transform the vertices of steps whose world matrix changed since they were last drawn
+void refreshStepPoints()
+{
+    for (int i = 0; i < 4; i++)
+    {
+        const SceneNode2D &node = scene.nodes[stepNodes[i]];
+        if (stepPointsVersion[i] == node.version)
+            continue;
+        for (int v = 0; v < 3; v++)
+            stepPoints[i][v] = transformPoint(triangle[v], node.world);
+        stepPointsVersion[i] = node.version;
+    }
+}
+
+// Scatter count copies of the triangle over a grid covering the window, each rotated differently
+void buildInstanceField(TriangleInstances &inst, size_t count)
+{
+    for (int v = 0; v < 3; v++)
+        inst.shape[v] = {triangle[v].x, triangle[v].y};
+
+    size_t side = static_cast<size_t>(ceil(sqrt(static_cast<double>(count))));
+    float cell = 2.0f / side;
+    float s = 0.8f * cell / 0.15f; // The triangle spans about 0.15 units
+
+    // Golden angle steps, wrapped so the batch sine/cosine stays in its accurate range
+    std::vector<float> angles(count);
+    std::vector<Rotate2D> rotations(count);
+    for (size_t i = 0; i < count; i++)
+        angles[i] = fmodf(static_cast<float>(i % 65536) * 2.39996323f, 2.0f * M_PI);
+    rotateBatch(angles.data(), rotations.data(), count);
+
+    inst.transforms.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        float x = -1.0f + (i % side + 0.5f) * cell;
+        float y = -1.0f + (i / side + 0.5f) * cell;
+        inst.transforms[i] = Affine2D::translate(x, y) * rotations[i] * Affine2D::scale(s, s) *
+                             Affine2D::translate(-triangleCentroid.x, -triangleCentroid.y);
+    }
+    inst.dirty = true;
+}
+
+// Draw the instance field on the GPU in two calls, or rasterize it on the CPU
+void drawInstanceField()
+{
+    static const float fill[3] = {0.2f, 0.6f, 0.9f};
+    static const float outline[3] = {1.0f, 1.0f, 1.0f};
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (cpuInstances)
+    {
+        instanceFrame.width = windowWidth;
+        instanceFrame.height = windowHeight;
+        rasterizeInstances(instances, instanceFrame, packColor(fill[0], fill[1], fill[2]),
+                           packColor(outline[0], outline[1], outline[2]), packColor(0.05f, 0.05f, 0.05f));
+        glRasterPos2f(-1.0f, -1.0f);
+        glDrawPixels(instanceFrame.width, instanceFrame.height, GL_RGBA, GL_UNSIGNED_BYTE, instanceFrame.pixels.data());
+    }
+    else
+    {
+        drawInstances(instances, fill, outline);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    std::cout << instances.transforms.size() << " instances (" << (cpuInstances ? "CPU" : "GL")
+              << "): " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
 }
 
 // Display callback function
@@ -199,119 +255,49 @@ void display()
 {
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // Draw grid first (background)
-    drawGrid();
-
-    // Draw axes (foreground)
-    drawAxes();
+    if (showInstances)
+    {
+        drawInstanceField();
+        glutSwapBuffers();
+        return;
+    }
 
-    // Draw axis labels
-    drawAxisLabels();
+    // Grid, axes and labels (cached)
+    drawBackground();
 
-    // Define original triangle in NDC coordinates - CENTER
-    Point t1 = {-0.08f, -0.1f}; // Bottom-left
-    Point t2 = {-0.08f, 0.05f}; // Top-left
-    Point t3 = {0.05f, -0.1f};  // Bottom-right
+    // Recompute the world matrices of edited steps only
+    int updated = scene.update();
+    if (updated > 0)
+    {
+        std::cout << "Recomputed " << updated << " of " << scene.nodes.size() << " steps ("
+                  << scene.products << " matrix products)\n";
+    }
+    refreshStepPoints();
 
     // Draw original triangle (BLUE with WHITE outline) - CENTER
     glColor3f(0.2f, 0.6f, 0.9f); // Blue fill
-    drawTriangle(t1, t2, t3);
-    drawTriangleOutline(t1, t2, t3, false); // White outline
+    drawTriangle(triangle[0], triangle[1], triangle[2]);
+    drawTriangleOutline(triangle[0], triangle[1], triangle[2], false); // White outline
 
     // ===== STEP 1: TRANSLATION (Left side) =====
-    Matrix3x3 T1;
-    translate(T1, -0.65f, 0.0f);
-
-    Point t1_step1 = transformPoint(t1, T1);
-    Point t2_step1 = transformPoint(t2, T1);
-    Point t3_step1 = transformPoint(t3, T1);
-
     glColor3f(0.9f, 0.3f, 0.3f); // Red fill
-    drawTriangle(t1_step1, t2_step1, t3_step1);
-    drawTriangleOutline(t1_step1, t2_step1, t3_step1, true); // Cyan outline
+    drawTriangle(stepPoints[0][0], stepPoints[0][1], stepPoints[0][2]);
+    drawTriangleOutline(stepPoints[0][0], stepPoints[0][1], stepPoints[0][2], true); // Cyan outline
 
     // ===== STEP 2: TRANSLATION + ROTATION (Top side) =====
-    Matrix3x3 T_to_origin, R, T_back, T2, temp1, temp2, temp3, result2;
-
-    Point center_step1 = getCentroid(t1_step1, t2_step1, t3_step1);
-
-    // Translate to origin
-    translate(T_to_origin, -center_step1.x, -center_step1.y);
-
-    // Rotate 45 degrees
-    rotate(R, 45.0f * M_PI / 180.0f);
-
-    // Translate back
-    translate(T_back, center_step1.x, center_step1.y);
-
-    // Additional translation to top
-    translate(T2, 0.65f, 0.62f);
-
-    // Compose: T2 * T_back * R * T_to_origin * T1
-    matrixMultiply(T_to_origin, T1, temp1);
-    matrixMultiply(R, temp1, temp2);
-    matrixMultiply(T_back, temp2, temp3);
-    matrixMultiply(T2, temp3, result2);
-
-    Point t1_step2 = transformPoint(t1, result2);
-    Point t2_step2 = transformPoint(t2, result2);
-    Point t3_step2 = transformPoint(t3, result2);
-
     glColor3f(1.0f, 0.8f, 0.0f); // Yellow fill
-    drawTriangle(t1_step2, t2_step2, t3_step2);
-    drawTriangleOutline(t1_step2, t2_step2, t3_step2, true); // Cyan outline
+    drawTriangle(stepPoints[1][0], stepPoints[1][1], stepPoints[1][2]);
+    drawTriangleOutline(stepPoints[1][0], stepPoints[1][1], stepPoints[1][2], true); // Cyan outline
 
     // ===== STEP 3: TRANSLATION + ROTATION + SCALE (Right side) =====
-    Matrix3x3 S, T_to_origin2, T_back2, T3, temp4, temp5, temp6, temp7, result3;
-
-    Point center_step2 = getCentroid(t1_step2, t2_step2, t3_step2);
-
-    // Translate to origin
-    translate(T_to_origin2, -center_step2.x, -center_step2.y);
-
-    // Scale 1.3x
-    scale(S, 1.3f, 1.3f);
-
-    // Translate back
-    translate(T_back2, center_step2.x, center_step2.y);
-
-    // Additional translation to right
-    translate(T3, 0.18f, -0.62f);
-
-    // Compose: T3 * T_back2 * S * T_to_origin2 * result2
-    matrixMultiply(T_to_origin2, result2, temp4);
-    matrixMultiply(S, temp4, temp5);
-    matrixMultiply(T_back2, temp5, temp6);
-    matrixMultiply(T3, temp6, result3);
-
-    Point t1_step3 = transformPoint(t1, result3);
-    Point t2_step3 = transformPoint(t2, result3);
-    Point t3_step3 = transformPoint(t3, result3);
-
     glColor3f(0.3f, 1.0f, 0.3f); // Green fill
-    drawTriangle(t1_step3, t2_step3, t3_step3);
-    drawTriangleOutline(t1_step3, t2_step3, t3_step3, true); // Cyan outline
+    drawTriangle(stepPoints[2][0], stepPoints[2][1], stepPoints[2][2]);
+    drawTriangleOutline(stepPoints[2][0], stepPoints[2][1], stepPoints[2][2], true); // Cyan outline
 
     // ===== STEP 4: TRANSLATION + ROTATION + SCALE + SHEAR (Bottom side) =====
-    Matrix3x3 Sh, T4, temp8, result4;
-
-    // Shear
-    shear(Sh, 0.8f, 0.0f);
-
-    // Additional translation to bottom
-    translate(T4, -0.18f, -0.65f);
-
-    // Compose: T4 * Sh * result3
-    matrixMultiply(Sh, result3, temp8);
-    matrixMultiply(T4, temp8, result4);
-
-    Point t1_step4 = transformPoint(t1, result4);
-    Point t2_step4 = transformPoint(t2, result4);
-    Point t3_step4 = transformPoint(t3, result4);
-
     glColor3f(1.0f, 0.3f, 0.8f); // Magenta fill
-    drawTriangle(t1_step4, t2_step4, t3_step4);
-    drawTriangleOutline(t1_step4, t2_step4, t3_step4, true); // Cyan outline
+    drawTriangle(stepPoints[3][0], stepPoints[3][1], stepPoints[3][2]);
+    drawTriangleOutline(stepPoints[3][0], stepPoints[3][1], stepPoints[3][2], true); // Cyan outline
 
     glutSwapBuffers();
 }
@@ -319,6 +305,9 @@ void display()
 // Reshape callback
 void reshape(int width, int height)
 {
+    invalidateBackground();
+    windowWidth = width;
+    windowHeight = height;
     glViewport(0, 0, width, height);
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
@@ -374,6 +363,12 @@ void displayTransformInfo()
     std::cout << "  - After Step 3 (Green) - RIGHT side\n";
     std::cout << "  - After Step 4 - FINAL (Magenta) - BOTTOM side\n";
     std::cout << "\n  Layout: Transformed triangles surround the center original\n";
+    std::cout << "Controls (only the edited step and the ones after it are recomputed):\n";
+    std::cout << "  r/R - Rotate step 2 by +/-15 degrees\n";
+    std::cout << "  s/S - Scale step 3 by +/-0.1\n";
+    std::cout << "  h/H - Shear step 4 by +/-0.1\n";
+    std::cout << "  i   - Toggle the field of " << instanceCount << " instances\n";
+    std::cout << "  c   - Toggle CPU rasterization of the instance field\n";
     std::cout << "Press ESC to exit\n";
     std::cout << "========================================================\n\n";
 }
@@ -381,15 +376,87 @@ void displayTransformInfo()
 // Keyboard callback
 void keyboard(unsigned char key, int x, int y)
 {
-    if (key == 27) // ESC key
+    switch (key)
     {
+    case 'r':
+    case 'R':
+        rotationDegrees += (key == 'r') ? 15.0f : -15.0f;
+        scene.setOp(stepNodes[1], Affine2D::rotate(rotationDegrees * M_PI / 180.0f));
+        std::cout << "Rotation: " << rotationDegrees << " degrees\n";
+        break;
+    case 's':
+    case 'S':
+        scaleFactor += (key == 's') ? 0.1f : -0.1f;
+        scene.setOp(stepNodes[2], Affine2D::scale(scaleFactor, scaleFactor));
+        std::cout << "Scale: " << scaleFactor << "\n";
+        break;
+    case 'h':
+    case 'H':
+        shearX += (key == 'h') ? 0.1f : -0.1f;
+        scene.setOp(stepNodes[3], Affine2D::shear(shearX, 0.0f));
+        std::cout << "Shear: " << shearX << "\n";
+        break;
+    case 'i':
+        showInstances = !showInstances;
+        if (showInstances && instances.transforms.size() != instanceCount)
+            buildInstanceField(instances, instanceCount);
+        break;
+    case 'c':
+        cpuInstances = !cpuInstances;
+        std::cout << "Instance rendering: " << (cpuInstances ? "CPU" : "GL") << "\n";
+        break;
+    case 27: // ESC key
         exit(0);
     }
+    glutPostRedisplay();
 }
 
 // Main function
 int main(int argc, char **argv)
 {
+    // --instances N sets the size of the instance field
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--instances") == 0)
+            instanceCount = strtoul(argv[i + 1], nullptr, 10);
+    }
+
+    // Headless throughput comparison of transformPoint and transformPoints
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        // Step 4 style composite: T4 * Sh * S * R * T1 (pivots omitted)
+        Matrix3x3 T1, R, S, Sh, T4, temp1, temp2, temp3, M;
+        translate(T1, -0.65f, 0.0f);
+        rotate(R, 45.0f * M_PI / 180.0f);
+        scale(S, 1.3f, 1.3f);
+        shear(Sh, 0.8f, 0.0f);
+        translate(T4, -0.18f, -0.65f);
+        matrixMultiply(R, T1, temp1);
+        matrixMultiply(S, temp1, temp2);
+        matrixMultiply(Sh, temp2, temp3);
+        matrixMultiply(T4, temp3, M);
+
+        benchmarkTransformPoints<Point>([&M](Point p)
+                                        { return transformPoint(p, M); },
+                                        M, 10000000);
+        benchmarkRotations(instanceCount);
+
+        // CPU path of the instance field at the default window size
+        buildInstanceField(instances, instanceCount);
+        instanceFrame.width = windowWidth;
+        instanceFrame.height = windowHeight;
+        auto t0 = std::chrono::steady_clock::now();
+        expandInstances(instances);
+        auto t1 = std::chrono::steady_clock::now();
+        rasterizeInstances(instances, instanceFrame, packColor(0.2f, 0.6f, 0.9f),
+                           packColor(1.0f, 1.0f, 1.0f), packColor(0.05f, 0.05f, 0.05f));
+        auto t2 = std::chrono::steady_clock::now();
+        std::cout << "Instance field of " << instanceCount << " triangles at " << windowWidth << "x" << windowHeight << "\n";
+        std::cout << "  expandInstances    : " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
+        std::cout << "  rasterizeInstances : " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms\n";
+        return 0;
+    }
+
     // Initialize GLUT
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
@@ -411,6 +478,9 @@ int main(int argc, char **argv)
     // Display transformation information
     displayTransformInfo();
 
+    // Build the step hierarchy
+    initScene();
+
     // Register callbacks
     glutDisplayFunc(display);
     glutReshapeFunc(reshape);
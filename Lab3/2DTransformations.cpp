@@ -1,6 +1,12 @@
 #include <GL/glut.h>
 #include <iostream>
+#include <chrono>
 #include <cmath>
+#include <cstring>
+
+#include "Transform2D.h"
+#include "Background2D.h"
+#include "Raster2D.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -25,12 +31,39 @@ enum TransformMode
     REFLECT_Y
 };
 
+// Transform in decomposed form, composed as T(pivot + offset) * R * Sh * S * T(-pivot)
+struct TransformParams
+{
+    Vec2f pivot;
+    Vec2f offset;
+    Rotate2D rotation;
+    Vec2f shear;
+    Vec2f scale;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+const double UPDATE_STEP = 1.0 / 120.0;   // Fixed simulation step (seconds)
+const double FRAME_INTERVAL = 1.0 / 60.0; // Target frame interval (seconds)
+const int MAX_UPDATE_STEPS = 10;          // Steps run per frame before time is dropped
+const double ANIMATION_PERIOD = 2.0;      // Seconds from original to target pose
+
 // Global variables
 TransformMode currentMode = NONE;
-float animationTime = 0.0f;
+float animationTime = 0.0f; // Seconds into the current ping-pong cycle, wrapped every step
 int windowWidth = 800;
 int windowHeight = 600;
 
+// Animation state
+bool animating = false;
+int animationGeneration = 0;
+TransformMode animationTargetMode = NONE;
+TransformParams animationTarget;
+Clock::time_point lastTick, nextFrame, lastFrame, statsStart;
+double stepAccumulator = 0.0;
+double frameTimeSum = 0.0, frameTimeMin = 0.0, frameTimeMax = 0.0;
+int frameCount = 0;
+
 // Transform a point using a 3x3 transformation matrix
 Point transformPoint(Point p, float M[3][3])
 {
@@ -40,6 +73,12 @@ Point transformPoint(Point p, float M[3][3])
     return result;
 }
 
+// Transform a point by an affine transform of any kind
+Point transformPoint(Point p, const Affine2D &M)
+{
+    return M.apply(p);
+}
+
 // Matrix multiplication for composite transformations
 void multiplyMatrix(float result[3][3], float m1[3][3], float m2[3][3])
 {
@@ -69,78 +108,6 @@ Point getCentroid(Point p1, Point p2, Point p3)
     return centroid;
 }
 
-// Draw coordinate axes with labels
-void drawAxes()
-{
-    glLineWidth(3.0f);
-    glColor3f(0.5f, 0.5f, 0.5f);
-
-    // X-axis
-    glBegin(GL_LINES);
-    glVertex2f(-1.0f, 0.0f);
-    glVertex2f(1.0f, 0.0f);
-    glEnd();
-
-    // X-axis arrow
-    glBegin(GL_TRIANGLES);
-    glVertex2f(1.0f, 0.0f);
-    glVertex2f(0.95f, 0.02f);
-    glVertex2f(0.95f, -0.02f);
-    glEnd();
-
-    // Y-axis
-    glBegin(GL_LINES);
-    glVertex2f(0.0f, -1.0f);
-    glVertex2f(0.0f, 1.0f);
-    glEnd();
-
-    // Y-axis arrow
-    glBegin(GL_TRIANGLES);
-    glVertex2f(0.0f, 1.0f);
-    glVertex2f(0.02f, 0.95f);
-    glVertex2f(-0.02f, 0.95f);
-    glEnd();
-
-    glLineWidth(1.0f);
-}
-
-// Draw axis labels
-void drawAxisLabels()
-{
-    glColor3f(1.0f, 1.0f, 1.0f);
-
-    // X label
-    glRasterPos2f(0.92f, -0.08f);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, 'X');
-
-    // Y label
-    glRasterPos2f(0.03f, 0.92f);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, 'Y');
-
-    // Origin label
-    glRasterPos2f(0.02f, -0.05f);
-    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, 'O');
-}
-
-// Draw grid
-void drawGrid()
-{
-    glColor3f(0.2f, 0.2f, 0.2f);
-    glBegin(GL_LINES);
-
-    for (float i = -1.0f; i <= 1.0f; i += 0.1f)
-    {
-        // Vertical lines
-        glVertex2f(i, -1.0f);
-        glVertex2f(i, 1.0f);
-        // Horizontal lines
-        glVertex2f(-1.0f, i);
-        glVertex2f(1.0f, i);
-    }
-
-    glEnd();
-}
-
 // Draw a triangle (filled) - now using NDC coordinates directly
 void drawTriangle(Point p1, Point p2, Point p3)
 {
@@ -166,10 +133,7 @@ void drawTriangleOutline(Point p1, Point p2, Point p3)
 // Translation transformation
 void translate(Point p1, Point p2, Point p3, float tx, float ty)
 {
-    float T[3][3] = {
-        {1, 0, tx},
-        {0, 1, ty},
-        {0, 0, 1}};
+    Translate2D T = Affine2D::translate(tx, ty);
 
     Point tp1 = transformPoint(p1, T);
     Point tp2 = transformPoint(p2, T);
@@ -187,28 +151,16 @@ void scale(Point p1, Point p2, Point p3, float scaleX, float scaleY)
     Point centroid = getCentroid(p1, p2, p3);
 
     // Translate to origin
-    float T1[3][3] = {
-        {1, 0, -centroid.x},
-        {0, 1, -centroid.y},
-        {0, 0, 1}};
+    Translate2D T1 = Affine2D::translate(-centroid.x, -centroid.y);
 
     // Scale
-    float S[3][3] = {
-        {scaleX, 0, 0},
-        {0, scaleY, 0},
-        {0, 0, 1}};
+    Scale2D S = Affine2D::scale(scaleX, scaleY);
 
     // Translate back and offset to avoid overlap
-    float T2[3][3] = {
-        {1, 0, centroid.x + 0.6f},
-        {0, 1, centroid.y},
-        {0, 0, 1}};
+    Translate2D T2 = Affine2D::translate(centroid.x + 0.6f, centroid.y);
 
     // Composite transformation: T2 * S * T1
-    float temp[3][3];
-    multiplyMatrix(temp, S, T1);
-    float M[3][3];
-    multiplyMatrix(M, T2, temp);
+    Affine2D M = T2 * S * T1;
 
     Point tp1 = transformPoint(p1, M);
     Point tp2 = transformPoint(p2, M);
@@ -226,28 +178,16 @@ void rotate(Point p1, Point p2, Point p3, float theta)
     Point centroid = getCentroid(p1, p2, p3);
 
     // Translate to origin
-    float T1[3][3] = {
-        {1, 0, -centroid.x},
-        {0, 1, -centroid.y},
-        {0, 0, 1}};
+    Translate2D T1 = Affine2D::translate(-centroid.x, -centroid.y);
 
     // Rotate
-    float R[3][3] = {
-        {cos(theta), -sin(theta), 0},
-        {sin(theta), cos(theta), 0},
-        {0, 0, 1}};
+    Rotate2D R = Affine2D::rotate(theta);
 
     // Translate back and offset to avoid overlap
-    float T2[3][3] = {
-        {1, 0, centroid.x + 0.6f},
-        {0, 1, centroid.y + 0.3f},
-        {0, 0, 1}};
+    Translate2D T2 = Affine2D::translate(centroid.x + 0.6f, centroid.y + 0.3f);
 
     // Composite transformation: T2 * R * T1
-    float temp[3][3];
-    multiplyMatrix(temp, R, T1);
-    float M[3][3];
-    multiplyMatrix(M, T2, temp);
+    Affine2D M = T2 * R * T1;
 
     Point tp1 = transformPoint(p1, M);
     Point tp2 = transformPoint(p2, M);
@@ -263,20 +203,13 @@ void rotate(Point p1, Point p2, Point p3, float theta)
 void shear(Point p1, Point p2, Point p3, float shx, float shy)
 {
     // First translate to avoid overlap
-    float T[3][3] = {
-        {1, 0, 0.6f},
-        {0, 1, -0.3f},
-        {0, 0, 1}};
+    Translate2D T = Affine2D::translate(0.6f, -0.3f);
 
     // Then shear
-    float SH[3][3] = {
-        {1, shx, 0},
-        {shy, 1, 0},
-        {0, 0, 1}};
+    Shear2D SH = Affine2D::shear(shx, shy);
 
     // Composite: SH * T
-    float M[3][3];
-    multiplyMatrix(M, SH, T);
+    Affine2D M = SH * T;
 
     Point tp1 = transformPoint(p1, M);
     Point tp2 = transformPoint(p2, M);
@@ -292,10 +225,7 @@ void shear(Point p1, Point p2, Point p3, float shx, float shy)
 void reflectX(Point p1, Point p2, Point p3)
 {
     // Simply reflect across X-axis (y = 0)
-    float RX[3][3] = {
-        {1, 0, 0},
-        {0, -1, 0},
-        {0, 0, 1}};
+    Scale2D RX = Affine2D::scale(1, -1);
 
     Point tp1 = transformPoint(p1, RX);
     Point tp2 = transformPoint(p2, RX);
@@ -311,10 +241,7 @@ void reflectX(Point p1, Point p2, Point p3)
 void reflectY(Point p1, Point p2, Point p3)
 {
     // Simply reflect across Y-axis (x = 0)
-    float RY[3][3] = {
-        {-1, 0, 0},
-        {0, 1, 0},
-        {0, 0, 1}};
+    Scale2D RY = Affine2D::scale(-1, 1);
 
     Point tp1 = transformPoint(p1, RY);
     Point tp2 = transformPoint(p2, RY);
@@ -326,19 +253,158 @@ void reflectY(Point p1, Point p2, Point p3)
     drawTriangleOutline(tp1, tp2, tp3);
 }
 
+// Decomposed target pose of each mode, equal to the matrix its static function builds.
+// The only trig is here, once per mode change
+TransformParams targetParams(TransformMode mode, Point centroid)
+{
+    TransformParams t = {{0, 0}, {0, 0}, {1, 0}, {0, 0}, {1, 1}};
+    switch (mode)
+    {
+    case TRANSLATE:
+        t.offset = {0.5f, 0.3f};
+        break;
+    case SCALE:
+        t.pivot = {centroid.x, centroid.y};
+        t.offset = {0.6f, 0.0f};
+        t.scale = {1.5f, 1.5f};
+        break;
+    case ROTATE:
+        t.pivot = {centroid.x, centroid.y};
+        t.offset = {0.6f, 0.3f};
+        t.rotation = Affine2D::rotate(M_PI / 3);
+        break;
+    case SHEAR:
+        // SH * T(0.6, -0.3) == T(SH * (0.6, -0.3)) * SH
+        t.shear = {0.4f, 0.2f};
+        t.offset = Affine2D::shear(0.4f, 0.2f).apply(Vec2f{0.6f, -0.3f});
+        break;
+    case REFLECT_X:
+        t.scale = {1.0f, -1.0f};
+        break;
+    case REFLECT_Y:
+        t.scale = {-1.0f, 1.0f};
+        break;
+    case NONE:
+        break;
+    }
+    return t;
+}
+
+// Pose at fraction u of the way from the original triangle to the target. The rotation
+// is a normalized lerp of its (cos, sin) pair, so no sin/cos is evaluated per frame
+Affine2D interpolatePose(const TransformParams &to, float u)
+{
+    float c = 1.0f + (to.rotation.cosT - 1.0f) * u;
+    float s = to.rotation.sinT * u;
+    float len = sqrt(c * c + s * s);
+    Rotate2D rotation = {c / len, s / len};
+
+    return Affine2D::translate(to.pivot.x + to.offset.x * u, to.pivot.y + to.offset.y * u) *
+           rotation *
+           Affine2D::shear(to.shear.x * u, to.shear.y * u) *
+           Affine2D::scale(1.0f + (to.scale.x - 1.0f) * u, 1.0f + (to.scale.y - 1.0f) * u) *
+           Affine2D::translate(-to.pivot.x, -to.pivot.y);
+}
+
+// Draw the current mode's transform at the pose reached at animationTime
+void drawAnimated(Point p1, Point p2, Point p3)
+{
+    if (animationTargetMode != currentMode)
+    {
+        animationTarget = targetParams(currentMode, getCentroid(p1, p2, p3));
+        animationTargetMode = currentMode;
+    }
+
+    // Ping-pong between the original and the target pose, eased at both ends
+    float phase = fmod(animationTime, 2.0 * ANIMATION_PERIOD) / ANIMATION_PERIOD;
+    float u = phase < 1.0f ? phase : 2.0f - phase;
+    u = u * u * (3.0f - 2.0f * u);
+
+    Affine2D M = interpolatePose(animationTarget, u);
+    Point tp1 = transformPoint(p1, M);
+    Point tp2 = transformPoint(p2, M);
+    Point tp3 = transformPoint(p3, M);
+
+    glColor3f(0.9f, 0.3f, 0.3f);
+    drawTriangle(tp1, tp2, tp3);
+    glColor3f(0.0f, 1.0f, 1.0f);
+    drawTriangleOutline(tp1, tp2, tp3);
+}
+
+// Accumulate the time between presented frames and report it every two seconds
+void recordFrameTime()
+{
+    Clock::time_point now = Clock::now();
+    double ms = std::chrono::duration<double, std::milli>(now - lastFrame).count();
+    lastFrame = now;
+
+    frameTimeSum += ms;
+    frameTimeMin = frameCount == 0 ? ms : std::min(frameTimeMin, ms);
+    frameTimeMax = frameCount == 0 ? ms : std::max(frameTimeMax, ms);
+    frameCount++;
+
+    if (std::chrono::duration<double>(now - statsStart).count() >= 2.0)
+    {
+        double avg = frameTimeSum / frameCount;
+        std::cout << "Frame time: avg " << avg << " ms, min " << frameTimeMin << " ms, max "
+                  << frameTimeMax << " ms (" << 1000.0 / avg << " fps)\n";
+        frameTimeSum = 0.0;
+        frameCount = 0;
+        statsStart = now;
+    }
+}
+
+// Frame pacing: advance the animation in fixed steps for the real time that passed,
+// request a redraw, then schedule the next tick for the next frame boundary
+void animationTimer(int generation)
+{
+    if (!animating || generation != animationGeneration)
+        return;
+
+    Clock::time_point now = Clock::now();
+    stepAccumulator += std::chrono::duration<double>(now - lastTick).count();
+    lastTick = now;
+
+    int steps = 0;
+    while (stepAccumulator >= UPDATE_STEP && steps < MAX_UPDATE_STEPS)
+    {
+        animationTime = static_cast<float>(fmod(animationTime + UPDATE_STEP, 2.0 * ANIMATION_PERIOD));
+        stepAccumulator -= UPDATE_STEP;
+        steps++;
+    }
+    if (steps == MAX_UPDATE_STEPS)
+        stepAccumulator = 0.0; // After a stall, drop the backlog instead of fast-forwarding
+
+    glutPostRedisplay();
+
+    nextFrame += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(FRAME_INTERVAL));
+    if (nextFrame < now)
+        nextFrame = now;
+    double delay = std::chrono::duration<double, std::milli>(nextFrame - now).count();
+    glutTimerFunc(static_cast<unsigned>(ceil(delay)), animationTimer, generation);
+}
+
+void setAnimating(bool on)
+{
+    animating = on;
+    animationGeneration++;
+    if (!on)
+        return;
+
+    lastTick = nextFrame = lastFrame = statsStart = Clock::now();
+    stepAccumulator = 0.0;
+    frameCount = 0;
+    frameTimeSum = 0.0;
+    glutTimerFunc(0, animationTimer, animationGeneration);
+}
+
 // Display callback function
 void display()
 {
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // Draw grid first (background)
-    drawGrid();
-
-    // Draw axes (foreground, more visible)
-    drawAxes();
-
-    // Draw axis labels
-    drawAxisLabels();
+    // Grid, axes and labels (cached)
+    drawBackground();
 
     // Define original triangle vertices in NDC coordinates
     // Positioned so reflections work naturally with axes
@@ -353,6 +419,14 @@ void display()
     drawTriangleOutline(p1, p2, p3);
 
     // Apply transformation based on current mode
+    if (animating)
+    {
+        drawAnimated(p1, p2, p3);
+        recordFrameTime();
+        glutSwapBuffers();
+        return;
+    }
+
     switch (currentMode)
     {
     case TRANSLATE:
@@ -414,6 +488,11 @@ void keyboard(unsigned char key, int x, int y)
         animationTime = 0.0f;
         std::cout << "Mode: NONE (Original)\n";
         break;
+    case 'a':
+    case 'A':
+        setAnimating(!animating);
+        std::cout << "Animation: " << (animating ? "ON" : "OFF") << "\n";
+        break;
     case 27: // ESC key
         exit(0);
         break;
@@ -426,6 +505,7 @@ void keyboard(unsigned char key, int x, int y)
 // Reshape callback
 void reshape(int width, int height)
 {
+    invalidateBackground();
     windowWidth = width;
     windowHeight = height;
     glViewport(0, 0, width, height);
@@ -450,13 +530,93 @@ void displayInstructions()
     std::cout << "  5 - Reflect across X-axis\n";
     std::cout << "  6 - Reflect across Y-axis\n";
     std::cout << "  0 - Reset (show original)\n";
+    std::cout << "  A - Toggle animation of the current mode\n";
     std::cout << "  ESC - Exit\n";
     std::cout << "=================================\n\n";
 }
 
+// Headless run of the software rasterizer on the triangles of every mode
+void benchmarkRasterizer()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Framebuffer2D fb;
+    fb.width = windowWidth;
+    fb.height = windowHeight;
+    fb.pixels.assign(static_cast<size_t>(fb.width) * fb.height, 0);
+
+    // Two triangles sharing the diagonal of a square must cover each of its pixels exactly once
+    Point q0 = {-0.7f, -0.6f}, q1 = {0.65f, -0.55f}, q2 = {0.6f, 0.7f}, q3 = {-0.75f, 0.5f};
+    std::vector<uint32_t> coverage(fb.pixels.size(), 0);
+    fillTriangleNDC(fb, q0, q1, q2, 1);
+    for (size_t i = 0; i < fb.pixels.size(); i++)
+        coverage[i] += fb.pixels[i];
+    std::fill(fb.pixels.begin(), fb.pixels.end(), 0);
+    fillTriangleNDC(fb, q0, q2, q3, 1);
+    size_t overlaps = 0;
+    for (size_t i = 0; i < fb.pixels.size(); i++)
+        overlaps += (coverage[i] + fb.pixels[i]) > 1;
+
+    // The original triangle and its image under each transform, scaled up to a useful size
+    Affine2D zoom = Affine2D::scale(1.8f, 1.8f);
+    Point p1 = {-0.5f, 0.1f}, p2 = {-0.5f, 0.4f}, p3 = {-0.2f, 0.1f};
+    Point c = getCentroid(p1, p2, p3);
+    Affine2D modes[7] = {
+        Affine2D::identity(),
+        Affine2D::translate(0.5f, 0.3f),
+        Affine2D::translate(c.x + 0.6f, c.y) * Affine2D::scale(1.5f, 1.5f) * Affine2D::translate(-c.x, -c.y),
+        Affine2D::translate(c.x + 0.6f, c.y + 0.3f) * Affine2D::rotate(M_PI / 3) * Affine2D::translate(-c.x, -c.y),
+        Affine2D::shear(0.4f, 0.2f) * Affine2D::translate(0.6f, -0.3f),
+        Affine2D::scale(1, -1),
+        Affine2D::scale(-1, 1)};
+
+    const int ROUNDS = 2000;
+    RasterStats stats;
+    auto t0 = Clock::now();
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        for (int m = 0; m < 7; m++)
+        {
+            Affine2D M = zoom * modes[m];
+            fillTriangleNDC(fb, transformPoint(p1, M), transformPoint(p2, M), transformPoint(p3, M),
+                            packColor(0.9f, 0.3f, 0.3f), &stats);
+        }
+    }
+    auto t1 = Clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    size_t blocks = stats.acceptedBlocks + stats.partialBlocks + stats.rejectedBlocks;
+    std::cout << "Rasterizing " << ROUNDS * 7 << " triangles at " << fb.width << "x" << fb.height << "\n";
+    std::cout << "  " << ms << " ms (" << ms * 1000.0 / (ROUNDS * 7) << " us per triangle)\n";
+    std::cout << "  8x8 blocks: " << stats.acceptedBlocks * 100.0 / blocks << "% filled, "
+              << stats.partialBlocks * 100.0 / blocks << "% tested per pixel, "
+              << stats.rejectedBlocks * 100.0 / blocks << "% skipped\n";
+    std::cout << "  Shared edge check: " << overlaps << " pixels covered twice\n";
+}
+
 // Main function
 int main(int argc, char **argv)
 {
+    // Headless throughput comparison of transformPoint and transformPoints
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        // Rotation about a pivot: T2 * R * T1
+        float s, c;
+        sinCos(M_PI / 3, s, c);
+        float T1[3][3] = {{1, 0, 0.4f}, {0, 1, -0.2f}, {0, 0, 1}};
+        float R[3][3] = {{c, -s, 0}, {s, c, 0}, {0, 0, 1}};
+        float T2[3][3] = {{1, 0, 0.2f}, {0, 1, 0.3f}, {0, 0, 1}};
+        float temp[3][3], M[3][3];
+        multiplyMatrix(temp, R, T1);
+        multiplyMatrix(M, T2, temp);
+
+        benchmarkTransformPoints<Point>([&M](Point p)
+                                        { return transformPoint(p, M); },
+                                        M, 10000000);
+        benchmarkRasterizer();
+        return 0;
+    }
+
     // Initialize GLUT
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
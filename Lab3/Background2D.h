@@ -0,0 +1,83 @@
+#ifndef BACKGROUND2D_H
+#define BACKGROUND2D_H
+
+#include <GL/glut.h>
+#include <vector>
+
+// Grid, axes and axis labels never change, so they are recorded once into a display list
+// and each frame replays it with a single glCallList. The list is rebuilt only after a resize
+const int GRID_LINES = 20; // Grid spacing of 2 / GRID_LINES in NDC
+
+inline GLuint backgroundList = 0;
+
+// Line endpoints of the grid. Positions come from the integer line index, so the
+// last line lands exactly on 1.0 instead of drifting past it as a float counter would
+inline std::vector<float> buildGridVertices()
+{
+    std::vector<float> v;
+    v.reserve((GRID_LINES + 1) * 8);
+    for (int i = 0; i <= GRID_LINES; i++)
+    {
+        float p = static_cast<float>(2 * i - GRID_LINES) / GRID_LINES;
+        float line[8] = {p, -1.0f, p, 1.0f,  // Vertical
+                         -1.0f, p, 1.0f, p}; // Horizontal
+        v.insert(v.end(), line, line + 8);
+    }
+    return v;
+}
+
+inline void buildBackground()
+{
+    static const float axisLines[] = {-1.0f, 0.0f, 1.0f, 0.0f,
+                                      0.0f, -1.0f, 0.0f, 1.0f};
+    static const float axisArrows[] = {1.0f, 0.0f, 0.95f, 0.02f, 0.95f, -0.02f,
+                                       0.0f, 1.0f, 0.02f, 0.95f, -0.02f, 0.95f};
+    std::vector<float> grid = buildGridVertices();
+
+    backgroundList = glGenLists(1);
+    glNewList(backgroundList, GL_COMPILE);
+    glEnableClientState(GL_VERTEX_ARRAY);
+
+    // Vertex arrays are copied into the list when it is compiled
+    glColor3f(0.2f, 0.2f, 0.2f);
+    glVertexPointer(2, GL_FLOAT, 0, grid.data());
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(grid.size() / 2));
+
+    glLineWidth(3.0f);
+    glColor3f(0.5f, 0.5f, 0.5f);
+    glVertexPointer(2, GL_FLOAT, 0, axisLines);
+    glDrawArrays(GL_LINES, 0, 4);
+    glVertexPointer(2, GL_FLOAT, 0, axisArrows);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glLineWidth(1.0f);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glRasterPos2f(0.92f, -0.08f);
+    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, 'X');
+    glRasterPos2f(0.03f, 0.92f);
+    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, 'Y');
+    glRasterPos2f(0.02f, -0.05f);
+    glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, 'O');
+
+    glEndList();
+}
+
+// Draw grid, axes and labels
+inline void drawBackground()
+{
+    if (backgroundList == 0)
+        buildBackground();
+    glCallList(backgroundList);
+}
+
+// Called from reshape; the next drawBackground records the list again
+inline void invalidateBackground()
+{
+    if (backgroundList != 0)
+        glDeleteLists(backgroundList, 1);
+    backgroundList = 0;
+}
+
+#endif
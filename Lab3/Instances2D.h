@@ -0,0 +1,167 @@
+#ifndef INSTANCES2D_H
+#define INSTANCES2D_H
+
+#include <GL/glut.h>
+#include <cstdint>
+
+#include "Transform2D.h"
+#include "Raster2D.h"
+
+// Many copies of one triangle, each placed by its own transform. The per-instance
+// transforms are expanded into one vertex array, so fills and outlines are drawn
+// with one call each instead of two glBegin/glEnd pairs per triangle
+struct TriangleInstances
+{
+    Vec2f shape[3];
+    std::vector<Affine2D> transforms;
+
+    // Set after editing transforms; the vertices are rebuilt on the next draw
+    bool dirty = true;
+
+    // 3 vertices per instance as interleaved x, y, and 3 edges per instance as index pairs
+    std::vector<float> vertices;
+    std::vector<GLuint> outlineIndices;
+};
+
+// Split [0, n) into one contiguous range per thread, inputs below minChunk stay on this thread
+template <typename Fn>
+void parallelRanges(size_t n, size_t minChunk, Fn fn)
+{
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min(threads, n / minChunk));
+    size_t chunk = (n + threads - 1) / threads;
+
+    std::vector<std::thread> workers;
+    for (size_t begin = chunk; begin < n; begin += chunk)
+        workers.emplace_back(fn, begin, std::min(n, begin + chunk));
+    fn(0, std::min(n, chunk));
+    for (auto &w : workers)
+        w.join();
+}
+
+inline void expandInstances(TriangleInstances &inst)
+{
+    size_t n = inst.transforms.size();
+    inst.vertices.resize(n * 6);
+
+    // The outline indices only depend on the instance count
+    if (inst.outlineIndices.size() != n * 6)
+    {
+        inst.outlineIndices.resize(n * 6);
+        for (size_t i = 0; i < n; i++)
+        {
+            GLuint v = static_cast<GLuint>(i * 3);
+            GLuint *e = &inst.outlineIndices[i * 6];
+            e[0] = v;
+            e[1] = v + 1;
+            e[2] = v + 1;
+            e[3] = v + 2;
+            e[4] = v + 2;
+            e[5] = v;
+        }
+    }
+
+    parallelRanges(n, 1 << 14, [&inst](size_t begin, size_t end)
+                   {
+                       for (size_t i = begin; i < end; i++)
+                       {
+                           const Affine2D &M = inst.transforms[i];
+                           float *out = &inst.vertices[i * 6];
+                           for (int v = 0; v < 3; v++)
+                           {
+                               Vec2f p = M.apply(inst.shape[v]);
+                               out[v * 2] = p.x;
+                               out[v * 2 + 1] = p.y;
+                           }
+                       } });
+    inst.dirty = false;
+}
+
+// Draw every instance: all fills in one call, then all outlines in one call
+inline void drawInstances(TriangleInstances &inst, const float fill[3], const float outline[3])
+{
+    if (inst.dirty)
+        expandInstances(inst);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, inst.vertices.data());
+
+    glColor3fv(fill);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(inst.transforms.size() * 3));
+
+    glLineWidth(2.0f);
+    glColor3fv(outline);
+    glDrawElements(GL_LINES, static_cast<GLsizei>(inst.outlineIndices.size()), GL_UNSIGNED_INT,
+                   inst.outlineIndices.data());
+    glLineWidth(1.0f);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// One pixel wide DDA line, restricted to rows [rowBegin, rowEnd)
+inline void drawLineRows(Framebuffer2D &fb, Vec2f a, Vec2f b, uint32_t color, int rowBegin, int rowEnd)
+{
+    float dx = b.x - a.x, dy = b.y - a.y;
+    int steps = static_cast<int>(std::ceil(std::max(std::fabs(dx), std::fabs(dy))));
+    if (steps == 0)
+        steps = 1;
+    float sx = dx / steps, sy = dy / steps;
+    for (int s = 0; s <= steps; s++)
+    {
+        int x = static_cast<int>(a.x + sx * s);
+        int y = static_cast<int>(a.y + sy * s);
+        if (x >= 0 && x < fb.width && y >= rowBegin && y < rowEnd)
+            fb.pixels[static_cast<size_t>(y) * fb.width + x] = color;
+    }
+}
+
+// CPU fallback for drawInstances: each thread owns a band of rows, clears it and draws the
+// part of every instance that falls inside it, so no two threads write the same pixel.
+// Like the GL path, all fills are drawn before all outlines
+inline void rasterizeInstances(TriangleInstances &inst, Framebuffer2D &fb,
+                               uint32_t fill, uint32_t outline, uint32_t background)
+{
+    if (inst.dirty)
+        expandInstances(inst);
+
+    size_t n = inst.transforms.size();
+    fb.pixels.resize(static_cast<size_t>(fb.width) * fb.height);
+
+    std::vector<Vec2f> screen(n * 3);
+    parallelRanges(n * 3, 1 << 16, [&](size_t begin, size_t end)
+                   {
+                       for (size_t v = begin; v < end; v++)
+                           screen[v] = ndcToPixel(fb, Vec2f{inst.vertices[v * 2], inst.vertices[v * 2 + 1]});
+                   });
+
+    parallelRanges(fb.height, 16, [&](size_t rowBegin, size_t rowEnd)
+                   {
+                       int r0 = static_cast<int>(rowBegin), r1 = static_cast<int>(rowEnd);
+                       std::fill(fb.pixels.begin() + rowBegin * fb.width, fb.pixels.begin() + rowEnd * fb.width, background);
+
+                       // Instances entirely above or below the band are skipped before any edge setup
+                       auto overlaps = [&](const Vec2f *t)
+                       {
+                           float lo = std::min({t[0].y, t[1].y, t[2].y});
+                           float hi = std::max({t[0].y, t[1].y, t[2].y});
+                           return hi >= r0 && lo < r1;
+                       };
+
+                       for (size_t i = 0; i < n; i++)
+                       {
+                           const Vec2f *t = &screen[i * 3];
+                           if (overlaps(t))
+                               fillTriangle(fb, t[0], t[1], t[2], fill, r0, r1);
+                       }
+                       for (size_t i = 0; i < n; i++)
+                       {
+                           const Vec2f *t = &screen[i * 3];
+                           if (!overlaps(t))
+                               continue;
+                           drawLineRows(fb, t[0], t[1], outline, r0, r1);
+                           drawLineRows(fb, t[1], t[2], outline, r0, r1);
+                           drawLineRows(fb, t[2], t[0], outline, r0, r1);
+                       } });
+}
+
+#endif
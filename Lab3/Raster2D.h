@@ -0,0 +1,261 @@
+#ifndef RASTER2D_H
+#define RASTER2D_H
+
+#include <climits>
+#include <cstdint>
+
+#include "Transform2D.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// RGBA8 pixels, row 0 at the bottom so it can be handed straight to glDrawPixels
+struct Framebuffer2D
+{
+    int width = 0, height = 0;
+    std::vector<uint32_t> pixels;
+};
+
+inline uint32_t packColor(float r, float g, float b)
+{
+    return static_cast<uint32_t>(r * 255) | static_cast<uint32_t>(g * 255) << 8 |
+           static_cast<uint32_t>(b * 255) << 16 | 0xFF000000u;
+}
+
+// Vertices are snapped to 1/16 pixel. Triangles with a vertex outside the guard band
+// are dropped; inside it the per-block edge values of crossing edges fit in 32 bits
+const int RASTER_SUBPIXEL_BITS = 4;
+const int64_t RASTER_SUBPIXEL = 1 << RASTER_SUBPIXEL_BITS;
+const float RASTER_GUARD_BAND = 65536.0f;
+const int RASTER_BLOCK = 8;
+
+struct RasterStats
+{
+    size_t acceptedBlocks = 0; // Fully inside, filled without per-pixel tests
+    size_t partialBlocks = 0;  // Crossed by an edge, tested per pixel
+    size_t rejectedBlocks = 0; // Outside one edge, skipped
+};
+
+// Half-space rasterizer. Each edge function E(x, y) = A*x + B*y + C is positive on the
+// inside and is stepped incrementally between 8x8 blocks. Per block, the edge values at
+// the extreme corners decide whether it is outside an edge (skip), inside all of them
+// (fill) or crossed (test its pixels, 8 per row at once). Pixel centres exactly on an
+// edge are filled only for top and left edges, so triangles sharing an edge cover each
+// pixel once. Vertices are in pixel units; only rows [rowBegin, rowEnd) are written
+inline void fillTriangle(Framebuffer2D &fb, Vec2f a, Vec2f b, Vec2f c, uint32_t color,
+                         int rowBegin = 0, int rowEnd = INT_MAX, RasterStats *stats = nullptr)
+{
+    const Vec2f v[3] = {a, b, c};
+    int64_t x[3], y[3];
+    for (int i = 0; i < 3; i++)
+    {
+        // Written so that NaN also fails
+        if (!(std::fabs(v[i].x) < RASTER_GUARD_BAND && std::fabs(v[i].y) < RASTER_GUARD_BAND))
+            return;
+        x[i] = std::llround(v[i].x * RASTER_SUBPIXEL);
+        y[i] = std::llround(v[i].y * RASTER_SUBPIXEL);
+    }
+
+    // Counter-clockwise order puts the inside on the positive side of every edge
+    int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (area == 0)
+        return;
+    if (area < 0)
+    {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+    }
+
+    // Pixel rectangle whose centres can be inside, clipped to the framebuffer and row range
+    const int64_t HALF = RASTER_SUBPIXEL / 2;
+    auto firstCentre = [HALF](int64_t lo)
+    { return static_cast<int>((lo - HALF + RASTER_SUBPIXEL - 1) >> RASTER_SUBPIXEL_BITS); };
+    auto lastCentre = [HALF](int64_t hi)
+    { return static_cast<int>((hi - HALF) >> RASTER_SUBPIXEL_BITS); };
+    int px0 = std::max(0, firstCentre(std::min({x[0], x[1], x[2]})));
+    int px1 = std::min(fb.width - 1, lastCentre(std::max({x[0], x[1], x[2]})));
+    int py0 = std::max({0, rowBegin, firstCentre(std::min({y[0], y[1], y[2]}))});
+    int py1 = std::min({fb.height - 1, rowEnd - 1, lastCentre(std::max({y[0], y[1], y[2]}))});
+    if (px0 > px1 || py0 > py1)
+        return;
+
+    int bx0 = px0 & ~(RASTER_BLOCK - 1);
+    int by0 = py0 & ~(RASTER_BLOCK - 1);
+
+    // Edge i runs from vertex i to vertex i + 1. E is evaluated at pixel centres and biased
+    // by -1 on edges that are neither top nor left, so "covered" is always E >= 0
+    int64_t A[3], B[3], rowStart[3], minOff[3], maxOff[3];
+    for (int i = 0; i < 3; i++)
+    {
+        int j = (i + 1) % 3;
+        int64_t dx = x[j] - x[i], dy = y[j] - y[i];
+        A[i] = -dy;
+        B[i] = dx;
+        bool topLeft = dy < 0 || (dy == 0 && dx < 0);
+        int64_t C = -(A[i] * x[i] + B[i] * y[i]) - (topLeft ? 0 : 1);
+        rowStart[i] = A[i] * (bx0 * RASTER_SUBPIXEL + HALF) + B[i] * (by0 * RASTER_SUBPIXEL + HALF) + C;
+
+        int64_t spanX = A[i] * RASTER_SUBPIXEL * (RASTER_BLOCK - 1);
+        int64_t spanY = B[i] * RASTER_SUBPIXEL * (RASTER_BLOCK - 1);
+        minOff[i] = std::min<int64_t>(0, spanX) + std::min<int64_t>(0, spanY);
+        maxOff[i] = std::max<int64_t>(0, spanX) + std::max<int64_t>(0, spanY);
+    }
+
+    const int64_t pixelStepX[3] = {A[0] * RASTER_SUBPIXEL, A[1] * RASTER_SUBPIXEL, A[2] * RASTER_SUBPIXEL};
+    const int64_t pixelStepY[3] = {B[0] * RASTER_SUBPIXEL, B[1] * RASTER_SUBPIXEL, B[2] * RASTER_SUBPIXEL};
+
+#if defined(__AVX2__)
+    // The three edges side by side; the unused fourth lane always accepts
+    const int64_t FAR_INSIDE = INT64_C(1) << 60;
+    __m256i vRow = _mm256_setr_epi64x(rowStart[0], rowStart[1], rowStart[2], FAR_INSIDE);
+    const __m256i vMinOff = _mm256_setr_epi64x(minOff[0], minOff[1], minOff[2], 0);
+    const __m256i vMaxOff = _mm256_setr_epi64x(maxOff[0], maxOff[1], maxOff[2], 0);
+    const __m256i vBlockX = _mm256_setr_epi64x(pixelStepX[0] * RASTER_BLOCK, pixelStepX[1] * RASTER_BLOCK,
+                                               pixelStepX[2] * RASTER_BLOCK, 0);
+    const __m256i vBlockY = _mm256_setr_epi64x(pixelStepY[0] * RASTER_BLOCK, pixelStepY[1] * RASTER_BLOCK,
+                                               pixelStepY[2] * RASTER_BLOCK, 0);
+    const __m256i vZero = _mm256_setzero_si256();
+    const __m256i vLane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i vColor = _mm256_set1_epi32(static_cast<int>(color));
+#else
+    int64_t row[3] = {rowStart[0], rowStart[1], rowStart[2]};
+#endif
+
+    size_t accepted = 0, partial = 0, rejected = 0;
+    for (int by = by0; by <= py1; by += RASTER_BLOCK)
+    {
+        int yBegin = std::max(by, py0), yEnd = std::min(by + RASTER_BLOCK - 1, py1);
+
+#if defined(__AVX2__)
+        __m256i vE = vRow;
+#else
+        int64_t e[3] = {row[0], row[1], row[2]};
+#endif
+        for (int bx = bx0; bx <= px1; bx += RASTER_BLOCK)
+        {
+            int xEnd = std::min(bx + RASTER_BLOCK - 1, fb.width - 1);
+            int64_t blockE[4];
+            int crossing = 0; // Bit i set when edge i passes through the block
+
+#if defined(__AVX2__)
+            __m256i vLo = _mm256_add_epi64(vE, vMinOff);
+            __m256i vHi = _mm256_add_epi64(vE, vMaxOff);
+            int outside = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(vZero, vHi)));
+            crossing = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(vZero, vLo)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(blockE), vE);
+            vE = _mm256_add_epi64(vE, vBlockX);
+#else
+            int outside = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                blockE[i] = e[i];
+                if (e[i] + maxOff[i] < 0)
+                    outside |= 1 << i;
+                if (e[i] + minOff[i] < 0)
+                    crossing |= 1 << i;
+                e[i] += pixelStepX[i] * RASTER_BLOCK;
+            }
+#endif
+
+            if (outside)
+            {
+                rejected++;
+                continue;
+            }
+
+            if (!crossing)
+            {
+                accepted++;
+                for (int py = yBegin; py <= yEnd; py++)
+                {
+                    uint32_t *out = &fb.pixels[static_cast<size_t>(py) * fb.width];
+                    std::fill(out + bx, out + xEnd + 1, color);
+                }
+                continue;
+            }
+
+            // Only crossing edges are tested; their values inside the block fit in 32 bits
+            partial++;
+            int32_t eRow[3] = {0, 0, 0}, stepX[3] = {0, 0, 0}, stepY[3] = {0, 0, 0};
+            for (int i = 0; i < 3; i++)
+            {
+                if (crossing & (1 << i))
+                {
+                    eRow[i] = static_cast<int32_t>(blockE[i] + pixelStepY[i] * (yBegin - by));
+                    stepX[i] = static_cast<int32_t>(pixelStepX[i]);
+                    stepY[i] = static_cast<int32_t>(pixelStepY[i]);
+                }
+            }
+
+#if defined(__AVX2__)
+            __m256i vEdge[3], vStepY[3];
+            for (int i = 0; i < 3; i++)
+            {
+                vEdge[i] = _mm256_add_epi32(_mm256_set1_epi32(eRow[i]),
+                                            _mm256_mullo_epi32(_mm256_set1_epi32(stepX[i]), vLane));
+                vStepY[i] = _mm256_set1_epi32(stepY[i]);
+            }
+            // Lanes past the right edge of the framebuffer are never stored
+            __m256i vColumns = _mm256_cmpgt_epi32(_mm256_set1_epi32(xEnd - bx + 1), vLane);
+            for (int py = yBegin; py <= yEnd; py++)
+            {
+                // A pixel is covered when no edge value has its sign bit set
+                __m256i vAny = _mm256_or_si256(_mm256_or_si256(vEdge[0], vEdge[1]), vEdge[2]);
+                __m256i vMask = _mm256_andnot_si256(vAny, vColumns);
+                uint32_t *out = &fb.pixels[static_cast<size_t>(py) * fb.width + bx];
+                _mm256_maskstore_epi32(reinterpret_cast<int *>(out), _mm256_srai_epi32(vMask, 31), vColor);
+                for (int i = 0; i < 3; i++)
+                    vEdge[i] = _mm256_add_epi32(vEdge[i], vStepY[i]);
+            }
+#else
+            for (int py = yBegin; py <= yEnd; py++)
+            {
+                uint32_t *out = &fb.pixels[static_cast<size_t>(py) * fb.width];
+                int32_t e0 = eRow[0], e1 = eRow[1], e2 = eRow[2];
+                for (int px = bx; px <= xEnd; px++)
+                {
+                    if ((e0 | e1 | e2) >= 0)
+                        out[px] = color;
+                    e0 += stepX[0];
+                    e1 += stepX[1];
+                    e2 += stepX[2];
+                }
+                for (int i = 0; i < 3; i++)
+                    eRow[i] += stepY[i];
+            }
+#endif
+        }
+
+#if defined(__AVX2__)
+        vRow = _mm256_add_epi64(vRow, vBlockY);
+#else
+        for (int i = 0; i < 3; i++)
+            row[i] += pixelStepY[i] * RASTER_BLOCK;
+#endif
+    }
+
+    if (stats)
+    {
+        stats->acceptedBlocks += accepted;
+        stats->partialBlocks += partial;
+        stats->rejectedBlocks += rejected;
+    }
+}
+
+// Map normalized device coordinates [-1, 1] onto the pixels of fb
+template <typename PointT>
+Vec2f ndcToPixel(const Framebuffer2D &fb, PointT p)
+{
+    return {(p.x + 1.0f) * 0.5f * fb.width, (p.y + 1.0f) * 0.5f * fb.height};
+}
+
+// Fill a triangle given in NDC, e.g. straight from transformPoint
+template <typename PointT>
+void fillTriangleNDC(Framebuffer2D &fb, PointT a, PointT b, PointT c, uint32_t color,
+                     RasterStats *stats = nullptr)
+{
+    fillTriangle(fb, ndcToPixel(fb, a), ndcToPixel(fb, b), ndcToPixel(fb, c), color, 0, INT_MAX, stats);
+}
+
+#endif
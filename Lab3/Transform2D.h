@@ -0,0 +1,680 @@
+#ifndef TRANSFORM2D_H
+#define TRANSFORM2D_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+// Affine transform kept as the top two rows of a homogeneous matrix:
+// | a b c |
+// | d e f |
+// | 0 0 1 |
+// The factories return tagged kinds (Translate2D, Scale2D, Rotate2D, Shear2D) so that
+// products of known kinds compile down to just the arithmetic they need
+struct Translate2D;
+struct Scale2D;
+struct Rotate2D;
+struct Shear2D;
+
+struct Affine2D
+{
+    float a, b, c;
+    float d, e, f;
+
+    static constexpr Translate2D translate(float tx, float ty);
+    static constexpr Scale2D scale(float sx, float sy);
+    static Rotate2D rotate(float theta);
+    static constexpr Rotate2D rotateConst(double theta);
+    static constexpr Shear2D shear(float shx, float shy);
+
+    static constexpr Affine2D identity()
+    {
+        return {1, 0, 0, 0, 1, 0};
+    }
+
+    static constexpr Affine2D fromMatrix(const float M[3][3])
+    {
+        return {M[0][0], M[0][1], M[0][2], M[1][0], M[1][1], M[1][2]};
+    }
+
+    void toMatrix(float M[3][3]) const
+    {
+        M[0][0] = a, M[0][1] = b, M[0][2] = c;
+        M[1][0] = d, M[1][1] = e, M[1][2] = f;
+        M[2][0] = 0, M[2][1] = 0, M[2][2] = 1;
+    }
+
+    template <typename PointT>
+    constexpr PointT apply(PointT p) const
+    {
+        return PointT{a * p.x + b * p.y + c, d * p.x + e * p.y + f};
+    }
+};
+
+struct Translate2D
+{
+    float tx, ty;
+    constexpr operator Affine2D() const { return {1, 0, tx, 0, 1, ty}; }
+
+    template <typename PointT>
+    constexpr PointT apply(PointT p) const { return PointT{p.x + tx, p.y + ty}; }
+};
+
+struct Scale2D
+{
+    float sx, sy;
+    constexpr operator Affine2D() const { return {sx, 0, 0, 0, sy, 0}; }
+
+    template <typename PointT>
+    constexpr PointT apply(PointT p) const { return PointT{p.x * sx, p.y * sy}; }
+};
+
+// Stores cos and sin rather than the angle, so composing rotations needs no trig
+struct Rotate2D
+{
+    float cosT, sinT;
+    constexpr operator Affine2D() const { return {cosT, -sinT, 0, sinT, cosT, 0}; }
+
+    template <typename PointT>
+    constexpr PointT apply(PointT p) const { return PointT{cosT * p.x - sinT * p.y, sinT * p.x + cosT * p.y}; }
+};
+
+struct Shear2D
+{
+    float shx, shy;
+    constexpr operator Affine2D() const { return {1, shx, 0, shy, 1, 0}; }
+
+    template <typename PointT>
+    constexpr PointT apply(PointT p) const { return PointT{p.x + shx * p.y, shy * p.x + p.y}; }
+};
+
+// Sine and cosine usable in constant expressions: reduce to [-pi, pi], then sum the
+// Taylor series far enough that the truncation error is below double precision
+constexpr double constReduceAngle(double x)
+{
+    const double PI = 3.14159265358979323846;
+    x -= static_cast<long long>(x / (2 * PI)) * (2 * PI);
+    if (x > PI)
+        x -= 2 * PI;
+    else if (x < -PI)
+        x += 2 * PI;
+    return x;
+}
+
+constexpr double constSin(double x)
+{
+    x = constReduceAngle(x);
+    double term = x, sum = x;
+    for (int n = 1; n < 14; n++)
+    {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constCos(double x)
+{
+    x = constReduceAngle(x);
+    double term = 1, sum = 1;
+    for (int n = 1; n < 14; n++)
+    {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+// Sine and cosine of one angle in a single call where the compiler offers it
+inline void sinCos(float theta, float &s, float &c)
+{
+#if defined(__GNUC__)
+    __builtin_sincosf(theta, &s, &c);
+#else
+    s = std::sin(theta);
+    c = std::cos(theta);
+#endif
+}
+
+constexpr Translate2D Affine2D::translate(float tx, float ty) { return {tx, ty}; }
+constexpr Scale2D Affine2D::scale(float sx, float sy) { return {sx, sy}; }
+inline Rotate2D Affine2D::rotate(float theta)
+{
+    Rotate2D r;
+    sinCos(theta, r.sinT, r.cosT);
+    return r;
+}
+constexpr Shear2D Affine2D::shear(float shx, float shy) { return {shx, shy}; }
+
+// Rotation by an angle known at compile time, folded to its cos/sin pair by the compiler
+constexpr Rotate2D Affine2D::rotateConst(double theta)
+{
+    return {static_cast<float>(constCos(theta)), static_cast<float>(constSin(theta))};
+}
+
+// Eager products. General product: 12 multiplies, the constant last row is never touched
+constexpr Affine2D multiply(const Affine2D &l, const Affine2D &r)
+{
+    return {l.a * r.a + l.b * r.d, l.a * r.b + l.b * r.e, l.a * r.c + l.b * r.f + l.c,
+            l.d * r.a + l.e * r.d, l.d * r.b + l.e * r.e, l.d * r.c + l.e * r.f + l.f};
+}
+
+// Specialized products, commented with the number of multiplies they cost
+constexpr Translate2D multiply(Translate2D l, Translate2D r) // 0
+{
+    return {l.tx + r.tx, l.ty + r.ty};
+}
+
+constexpr Scale2D multiply(Scale2D l, Scale2D r) // 2
+{
+    return {l.sx * r.sx, l.sy * r.sy};
+}
+
+constexpr Rotate2D multiply(Rotate2D l, Rotate2D r) // 4
+{
+    return {l.cosT * r.cosT - l.sinT * r.sinT, l.sinT * r.cosT + l.cosT * r.sinT};
+}
+
+constexpr Affine2D multiply(Translate2D l, const Affine2D &r) // 0
+{
+    return {r.a, r.b, r.c + l.tx, r.d, r.e, r.f + l.ty};
+}
+
+constexpr Affine2D multiply(const Affine2D &l, Translate2D r) // 4
+{
+    return {l.a, l.b, l.a * r.tx + l.b * r.ty + l.c, l.d, l.e, l.d * r.tx + l.e * r.ty + l.f};
+}
+
+constexpr Affine2D multiply(Translate2D l, Scale2D r) // 0
+{
+    return {r.sx, 0, l.tx, 0, r.sy, l.ty};
+}
+
+constexpr Affine2D multiply(Scale2D l, Translate2D r) // 2
+{
+    return {l.sx, 0, l.sx * r.tx, 0, l.sy, l.sy * r.ty};
+}
+
+constexpr Affine2D multiply(Translate2D l, Rotate2D r) // 0
+{
+    return {r.cosT, -r.sinT, l.tx, r.sinT, r.cosT, l.ty};
+}
+
+constexpr Affine2D multiply(Rotate2D l, Translate2D r) // 4
+{
+    return {l.cosT, -l.sinT, l.cosT * r.tx - l.sinT * r.ty, l.sinT, l.cosT, l.sinT * r.tx + l.cosT * r.ty};
+}
+
+constexpr Affine2D multiply(Translate2D l, Shear2D r) // 0
+{
+    return {1, r.shx, l.tx, r.shy, 1, l.ty};
+}
+
+constexpr Affine2D multiply(Shear2D l, Translate2D r) // 2
+{
+    return {1, l.shx, r.tx + l.shx * r.ty, l.shy, 1, l.shy * r.tx + r.ty};
+}
+
+constexpr Affine2D multiply(Scale2D l, const Affine2D &r) // 6
+{
+    return {l.sx * r.a, l.sx * r.b, l.sx * r.c, l.sy * r.d, l.sy * r.e, l.sy * r.f};
+}
+
+constexpr Affine2D multiply(const Affine2D &l, Scale2D r) // 4
+{
+    return {l.a * r.sx, l.b * r.sy, l.c, l.d * r.sx, l.e * r.sy, l.f};
+}
+
+constexpr Affine2D multiply(Shear2D l, const Affine2D &r) // 6
+{
+    return {r.a + l.shx * r.d, r.b + l.shx * r.e, r.c + l.shx * r.f,
+            l.shy * r.a + r.d, l.shy * r.b + r.e, l.shy * r.c + r.f};
+}
+
+// Any other pair of kinds falls back to the general product
+template <typename T>
+struct IsAffineKind
+{
+    static const bool value = false;
+};
+template <>
+struct IsAffineKind<Translate2D>
+{
+    static const bool value = true;
+};
+template <>
+struct IsAffineKind<Scale2D>
+{
+    static const bool value = true;
+};
+template <>
+struct IsAffineKind<Rotate2D>
+{
+    static const bool value = true;
+};
+template <>
+struct IsAffineKind<Shear2D>
+{
+    static const bool value = true;
+};
+
+template <typename L, typename R,
+          typename = typename std::enable_if<IsAffineKind<L>::value && IsAffineKind<R>::value>::type>
+constexpr Affine2D multiply(L l, R r)
+{
+    return multiply(static_cast<Affine2D>(l), static_cast<Affine2D>(r));
+}
+
+// Lazy composition: a * b * c builds a tree of AffineProduct nodes holding the factors by
+// value. Nothing is multiplied until the product is converted to Affine2D, applied to a
+// point, or handed to transformPoints, so no intermediate matrix is ever stored
+template <typename L, typename R>
+struct AffineProduct;
+
+template <typename T>
+struct IsAffineOperand
+{
+    static const bool value = IsAffineKind<T>::value || std::is_same<T, Affine2D>::value;
+};
+template <typename L, typename R>
+struct IsAffineOperand<AffineProduct<L, R>>
+{
+    static const bool value = true;
+};
+
+template <typename T>
+constexpr const T &evalAffine(const T &x)
+{
+    return x;
+}
+
+template <typename L, typename R>
+constexpr auto evalAffine(const AffineProduct<L, R> &p);
+
+// Multiply x onto an already folded right-hand side
+template <typename T, typename Acc>
+constexpr auto prependTo(const T &x, const Acc &acc)
+{
+    return multiply(x, acc);
+}
+
+template <typename L, typename R, typename Acc>
+constexpr auto prependTo(const AffineProduct<L, R> &p, const Acc &acc)
+{
+    return prependTo(p.l, prependTo(p.r, acc));
+}
+
+template <typename L, typename R>
+struct AffineProduct
+{
+    L l;
+    R r;
+
+    constexpr operator Affine2D() const { return evalAffine(*this); }
+
+    // Applies the factors right to left, which for a few points is cheaper than folding
+    template <typename PointT>
+    constexpr PointT apply(PointT p) const
+    {
+        return l.apply(r.apply(p));
+    }
+};
+
+// Folds right to left, e.g. T2 * T_back * R * T_to_origin * T1 evaluates T_to_origin * T1
+// first. Chains of cheap kinds in front of a general matrix then only pay for the
+// specialized kind * matrix products
+template <typename L, typename R>
+constexpr auto evalAffine(const AffineProduct<L, R> &p)
+{
+    return prependTo(p.l, evalAffine(p.r));
+}
+
+template <typename L, typename R,
+          typename = typename std::enable_if<IsAffineOperand<L>::value && IsAffineOperand<R>::value>::type>
+constexpr AffineProduct<L, R> operator*(const L &l, const R &r)
+{
+    return {l, r};
+}
+
+struct Vec2f
+{
+    float x, y;
+};
+
+// One node of a SceneGraph2D. Its world transform is
+//   offset * T(p) * op * T(-p) * parent.world
+// where p is the model-space pivot mapped through the parent's world transform
+// (op acts about the origin when pivoted is false)
+struct SceneNode2D
+{
+    int parent;
+    Affine2D op;
+    Translate2D offset;
+    bool pivoted;
+    Vec2f pivot;
+    Affine2D world;
+    bool dirty;
+    unsigned version;
+};
+
+// Transform hierarchy with cached world matrices. Editing a node marks it and its
+// descendants dirty, and update() recomputes only those; with nothing dirty it does no
+// matrix math at all. Parents are always added before their children, so index order
+// is a valid update order
+struct SceneGraph2D
+{
+    std::vector<SceneNode2D> nodes;
+    std::vector<std::vector<int>> children;
+    int products = 0; // matrix products computed by the last update()
+
+    int add(int parent, const Affine2D &op, Translate2D offset, bool pivoted = false, Vec2f pivot = {0, 0})
+    {
+        nodes.push_back({parent, op, offset, pivoted, pivot, Affine2D::identity(), true, 0});
+        children.emplace_back();
+        int index = static_cast<int>(nodes.size()) - 1;
+        if (parent >= 0)
+            children[parent].push_back(index);
+        return index;
+    }
+
+    void setOp(int node, const Affine2D &op)
+    {
+        nodes[node].op = op;
+        markDirty(node);
+    }
+
+    void setOffset(int node, Translate2D offset)
+    {
+        nodes[node].offset = offset;
+        markDirty(node);
+    }
+
+    // A dirty node's subtree is already dirty, so the walk stops there
+    void markDirty(int node)
+    {
+        if (nodes[node].dirty)
+            return;
+        nodes[node].dirty = true;
+        for (int child : children[node])
+            markDirty(child);
+    }
+
+    // Returns the number of nodes whose world transform was recomputed
+    int update()
+    {
+        int updated = 0;
+        products = 0;
+        for (auto &n : nodes)
+        {
+            if (!n.dirty)
+                continue;
+
+            Affine2D parentWorld = n.parent >= 0 ? nodes[n.parent].world : Affine2D::identity();
+            Affine2D local = n.op;
+            if (n.pivoted)
+            {
+                Vec2f p = parentWorld.apply(n.pivot);
+                local = Affine2D::translate(p.x, p.y) * n.op * Affine2D::translate(-p.x, -p.y);
+                products += 2;
+            }
+            n.world = n.offset * local * parentWorld;
+            products += 2;
+
+            n.dirty = false;
+            n.version++;
+            updated++;
+        }
+        return updated;
+    }
+};
+
+// Apply M to points [begin, end) of structure-of-arrays buffers
+inline void transformPointsRange(Affine2D M, const float *xs, const float *ys,
+                                 float *outX, float *outY, size_t begin, size_t end)
+{
+    const float a = M.a, b = M.b, c = M.c;
+    const float d = M.d, e = M.e, f = M.f;
+    size_t i = begin;
+
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b), vc = _mm256_set1_ps(c);
+    __m256 vd = _mm256_set1_ps(d), ve = _mm256_set1_ps(e), vf = _mm256_set1_ps(f);
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        _mm256_storeu_ps(outX + i, _mm256_fmadd_ps(va, x, _mm256_fmadd_ps(vb, y, vc)));
+        _mm256_storeu_ps(outY + i, _mm256_fmadd_ps(vd, x, _mm256_fmadd_ps(ve, y, vf)));
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        float x = xs[i], y = ys[i];
+        outX[i] = a * x + b * y + c;
+        outY[i] = d * x + e * y + f;
+    }
+}
+
+// Transform n points held as separate x and y arrays; large inputs are split across threads.
+// outX/outY may alias xs/ys for an in-place transform. Any kind or lazy product converts
+// to Affine2D here, so a composition is folded once and fused straight into the kernel
+inline void transformPoints(const Affine2D &M, const float *xs, const float *ys,
+                            float *outX, float *outY, size_t n)
+{
+    const size_t MIN_CHUNK = 1 << 18;
+
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, n / MIN_CHUNK);
+    if (threads <= 1)
+    {
+        transformPointsRange(M, xs, ys, outX, outY, 0, n);
+        return;
+    }
+
+    // Chunks are whole multiples of 8 so only the last one has a scalar tail
+    size_t chunk = ((n + threads - 1) / threads + 7) & ~static_cast<size_t>(7);
+    std::vector<std::thread> workers;
+    for (size_t begin = chunk; begin < n; begin += chunk)
+        workers.emplace_back(transformPointsRange, M, xs, ys, outX, outY, begin, std::min(n, begin + chunk));
+    transformPointsRange(M, xs, ys, outX, outY, 0, std::min(n, chunk));
+    for (auto &w : workers)
+        w.join();
+}
+
+inline void transformPoints(const float M[3][3], const float *xs, const float *ys,
+                            float *outX, float *outY, size_t n)
+{
+    transformPoints(Affine2D::fromMatrix(M), xs, ys, outX, outY, n);
+}
+
+// Polynomial sine and cosine for batches of angles (Cephes single precision kernels).
+// The angle is reduced to [-pi/4, pi/4] around the nearest multiple of pi/4 with a three
+// part pi/4, then both polynomials are evaluated and swapped or negated by octant.
+// Measured within 1.5 ulp for |theta| <= 2 pi; up to |theta| = 8192 the absolute error
+// stays below 1e-7, beyond that the reduction loses precision
+const float SINCOS_FOUR_OVER_PI = 1.27323954473516f;
+const float SINCOS_DP1 = 0.78515625f;
+const float SINCOS_DP2 = 2.4187564849853515625e-4f;
+const float SINCOS_DP3 = 3.77489497744594108e-8f;
+
+inline void sinCosPoly(float theta, float &s, float &c)
+{
+    float x = std::fabs(theta);
+    int j = (static_cast<int>(x * SINCOS_FOUR_OVER_PI) + 1) & ~1;
+    float y = static_cast<float>(j);
+    x = ((x - y * SINCOS_DP1) - y * SINCOS_DP2) - y * SINCOS_DP3;
+
+    float z = x * x;
+    float cosPoly = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+    float sinPoly = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * x + x;
+
+    bool swap = (j & 2) != 0;
+    s = swap ? cosPoly : sinPoly;
+    c = swap ? sinPoly : cosPoly;
+    if (((j & 4) != 0) != (theta < 0.0f))
+        s = -s;
+    if (((j - 2) & 4) == 0)
+        c = -c;
+}
+
+// Eight lanes at a time with the same steps, scalar tail
+inline void sinCosBatch(const float *theta, float *s, float *c, size_t n)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__) && defined(__FMA__)
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256i one = _mm256_set1_epi32(1), two = _mm256_set1_epi32(2), four = _mm256_set1_epi32(4);
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 t = _mm256_loadu_ps(theta + i);
+        __m256 x = _mm256_andnot_ps(signMask, t);
+        __m256i j = _mm256_andnot_si256(one, _mm256_add_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(SINCOS_FOUR_OVER_PI))), one));
+        __m256 y = _mm256_cvtepi32_ps(j);
+        x = _mm256_fnmadd_ps(y, _mm256_set1_ps(SINCOS_DP1), x);
+        x = _mm256_fnmadd_ps(y, _mm256_set1_ps(SINCOS_DP2), x);
+        x = _mm256_fnmadd_ps(y, _mm256_set1_ps(SINCOS_DP3), x);
+
+        __m256 z = _mm256_mul_ps(x, x);
+        __m256 cosPoly = _mm256_fmadd_ps(_mm256_set1_ps(2.443315711809948e-5f), z, _mm256_set1_ps(-1.388731625493765e-3f));
+        cosPoly = _mm256_fmadd_ps(cosPoly, z, _mm256_set1_ps(4.166664568298827e-2f));
+        cosPoly = _mm256_mul_ps(_mm256_mul_ps(cosPoly, z), z);
+        cosPoly = _mm256_add_ps(_mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, cosPoly), _mm256_set1_ps(1.0f));
+        __m256 sinPoly = _mm256_fmadd_ps(_mm256_set1_ps(-1.9515295891e-4f), z, _mm256_set1_ps(8.3321608736e-3f));
+        sinPoly = _mm256_fmadd_ps(sinPoly, z, _mm256_set1_ps(-1.6666654611e-1f));
+        sinPoly = _mm256_fmadd_ps(_mm256_mul_ps(sinPoly, z), x, x);
+
+        __m256 swap = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_and_si256(j, two), zero));
+        __m256 vs = _mm256_blendv_ps(sinPoly, cosPoly, swap);
+        __m256 vc = _mm256_blendv_ps(cosPoly, sinPoly, swap);
+
+        // Sign bits: sine flips in octants with bit 2 set and with the sign of theta,
+        // cosine flips when bit 2 of (j - 2) is clear
+        __m256 sinSign = _mm256_xor_ps(_mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, four), 29)),
+                                       _mm256_and_ps(t, signMask));
+        __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(j, two), four), 29));
+        _mm256_storeu_ps(s + i, _mm256_xor_ps(vs, sinSign));
+        _mm256_storeu_ps(c + i, _mm256_xor_ps(vc, cosSign));
+    }
+#endif
+
+    for (; i < n; i++)
+        sinCosPoly(theta[i], s[i], c[i]);
+}
+
+// Rotations for many angles at once, e.g. one per instance
+inline void rotateBatch(const float *theta, Rotate2D *out, size_t n)
+{
+    const size_t CHUNK = 256;
+    float s[CHUNK], c[CHUNK];
+    for (size_t begin = 0; begin < n; begin += CHUNK)
+    {
+        size_t count = std::min(CHUNK, n - begin);
+        sinCosBatch(theta + begin, s, c, count);
+        for (size_t k = 0; k < count; k++)
+            out[begin + k] = {c[k], s[k]};
+    }
+}
+
+// Time perPoint(p) over n points against transformPoints on the same data
+template <typename PointT, typename PerPoint>
+void benchmarkTransformPoints(PerPoint perPoint, const float M[3][3], size_t n)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<PointT> points(n), transformed(n);
+    std::vector<float> xs(n), ys(n), outX(n), outY(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        xs[i] = points[i].x = static_cast<float>(i % 2000) * 0.001f - 1.0f;
+        ys[i] = points[i].y = static_cast<float>(i / 2000 % 2000) * 0.001f - 1.0f;
+    }
+
+    // Best of several runs, so page faults and frequency ramp-up do not count
+    double perPointMs = 1e30, batchMs = 1e30;
+    for (int run = 0; run < 5; run++)
+    {
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < n; i++)
+            transformed[i] = perPoint(points[i]);
+        auto t1 = Clock::now();
+        transformPoints(M, xs.data(), ys.data(), outX.data(), outY.data(), n);
+        auto t2 = Clock::now();
+        perPointMs = std::min(perPointMs, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        batchMs = std::min(batchMs, std::chrono::duration<double, std::milli>(t2 - t1).count());
+    }
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < n; i++)
+    {
+        maxError = std::max(maxError, std::fabs(transformed[i].x - outX[i]));
+        maxError = std::max(maxError, std::fabs(transformed[i].y - outY[i]));
+    }
+
+    std::cout << "Transforming " << n << " points\n";
+    std::cout << "  transformPoint  : " << perPointMs << " ms (" << n / perPointMs / 1000.0 << " Mpts/s)\n";
+    std::cout << "  transformPoints : " << batchMs << " ms (" << n / batchMs / 1000.0 << " Mpts/s)\n";
+    std::cout << "  Speedup: " << perPointMs / batchMs << "x, max difference: " << maxError << "\n";
+}
+
+// Cost per instance of building rotations for n angles: the old double precision
+// cos/sin pairs, one sinCos per angle and rotateBatch
+inline void benchmarkRotations(size_t n)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<float> theta(n);
+    std::vector<Rotate2D> perAngle(n), batch(n);
+    std::vector<float> matrices(n * 4);
+    for (size_t i = 0; i < n; i++)
+        theta[i] = static_cast<float>(std::fmod(i * 2.39996323, 6.28318531) - 3.14159265);
+
+    double separateMs = 1e30, fusedMs = 1e30, batchMs = 1e30;
+    for (int run = 0; run < 5; run++)
+    {
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < n; i++)
+        {
+            float *R = &matrices[i * 4];
+            R[0] = std::cos(static_cast<double>(theta[i]));
+            R[1] = -std::sin(static_cast<double>(theta[i]));
+            R[2] = std::sin(static_cast<double>(theta[i]));
+            R[3] = std::cos(static_cast<double>(theta[i]));
+        }
+        auto t1 = Clock::now();
+        for (size_t i = 0; i < n; i++)
+            perAngle[i] = Affine2D::rotate(theta[i]);
+        auto t2 = Clock::now();
+        rotateBatch(theta.data(), batch.data(), n);
+        auto t3 = Clock::now();
+        separateMs = std::min(separateMs, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        fusedMs = std::min(fusedMs, std::chrono::duration<double, std::milli>(t2 - t1).count());
+        batchMs = std::min(batchMs, std::chrono::duration<double, std::milli>(t3 - t2).count());
+    }
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < n; i++)
+    {
+        maxError = std::max(maxError, std::fabs(batch[i].cosT - perAngle[i].cosT));
+        maxError = std::max(maxError, std::fabs(batch[i].sinT - perAngle[i].sinT));
+    }
+
+    std::cout << "Building " << n << " rotations\n";
+    std::cout << "  cos/sin twice (double) : " << separateMs * 1e6 / n << " ns per instance\n";
+    std::cout << "  Affine2D::rotate       : " << fusedMs * 1e6 / n << " ns per instance\n";
+    std::cout << "  rotateBatch            : " << batchMs * 1e6 / n << " ns per instance\n";
+    std::cout << "  Max difference of rotateBatch: " << maxError << "\n";
+}
+
+#endif
@@ -0,0 +1,421 @@
+#ifndef CLIPCACHE_H
+#define CLIPCACHE_H
+
+#include <GL/glut.h>
+
+#include "ClipEngine.h"
+#include "LineGrid.h"
+
+// Clipped results kept between redraws. The cache remembers the window version, line set
+// version and kernel it was built for, plus the clipped copy of every input line, so:
+//   - a redraw with nothing changed only submits the cached vertex buffer,
+//   - every visible line owns a slot of that buffer, so an update rewrites only the slots
+//     of the lines it re-clips,
+//   - appended lines and lines reported through invalidateLine are clipped on their own,
+//   - a moved or resized window re-clips only lines whose bounding boxes meet the old and
+//     the new window differently, found through a grid over the lines; lines appended or
+//     edited after the grid was built wait in a short side list instead of rebuilding it,
+//   - a replaced line set or another kernel re-clips everything
+struct ClipCache
+{
+    bool valid = false;
+    unsigned windowVersion = 0;
+    unsigned linesVersion = 0;
+    ClipKernel kernel = KERNEL_COHEN_SUTHERLAND;
+    float xMin = 0.0f, yMin = 0.0f, xMax = 0.0f, yMax = 0.0f; // Window the results are for
+
+    std::vector<Line> clipped;    // Clipped copy of every input line
+    std::vector<uint8_t> visible; // Whether anything of it is left
+    std::vector<uint32_t> dirty;  // Lines edited since the last update
+
+    // Visible segments as GL_LINES vertex pairs. Line i sits at slot[i] (4 floats per slot)
+    // and slotLine maps back; a line that stops being visible hands its slot to the last one
+    std::vector<float> vertices;
+    std::vector<uint32_t> slot;
+    std::vector<uint32_t> slotLine;
+    size_t reclipped = 0;        // Lines clipped by the last update
+    size_t candidates = 0;       // Lines a window move looked at in the last update
+    double gridMs = 0.0;         // Time the last update spent building the grid
+
+    // Grid over the lines for window moves, built on the first move after the line set is
+    // replaced. Lines appended or edited since then are listed in loose, which every move
+    // scans as well; the grid is only rebuilt once that list grows past a fraction of it
+    LineGrid grid;
+    bool gridValid = false;
+    size_t gridLines = 0;
+    unsigned gridVersion = 0;
+    std::vector<uint32_t> loose;
+    std::vector<uint8_t> isLoose;
+    unsigned gridBuilds = 0;
+};
+
+const uint32_t NO_SLOT = UINT32_MAX;
+
+// Put line i on the side list of lines the grid does not describe (if there is a grid)
+inline void loosenLine(ClipCache &cache, size_t i)
+{
+    if (!cache.gridValid)
+        return;
+    if (cache.isLoose.size() <= i)
+        cache.isLoose.resize(i + 1, 0);
+    if (!cache.isLoose[i])
+    {
+        cache.isLoose[i] = 1;
+        cache.loose.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+// Bring the vertex slot of line i in line with its visible flag and clipped copy
+inline void placeLine(ClipCache &cache, size_t i)
+{
+    uint32_t s = cache.slot[i];
+    if (cache.visible[i])
+    {
+        if (s == NO_SLOT)
+        {
+            s = cache.slot[i] = static_cast<uint32_t>(cache.slotLine.size());
+            cache.slotLine.push_back(static_cast<uint32_t>(i));
+            cache.vertices.resize(cache.vertices.size() + 4);
+        }
+        const Line &l = cache.clipped[i];
+        float *v = &cache.vertices[static_cast<size_t>(s) * 4];
+        v[0] = l.p1.x;
+        v[1] = l.p1.y;
+        v[2] = l.p2.x;
+        v[3] = l.p2.y;
+    }
+    else if (s != NO_SLOT)
+    {
+        uint32_t last = static_cast<uint32_t>(cache.slotLine.size() - 1);
+        uint32_t lastLine = cache.slotLine[last];
+        std::copy_n(&cache.vertices[static_cast<size_t>(last) * 4], 4, &cache.vertices[static_cast<size_t>(s) * 4]);
+        cache.slotLine[s] = lastLine;
+        cache.slot[lastLine] = s;
+        cache.slotLine.pop_back();
+        cache.vertices.resize(cache.vertices.size() - 4);
+        cache.slot[i] = NO_SLOT;
+    }
+}
+
+// Clip lines[i] again and update its slot
+inline void reclipLine(ClipCache &cache, const std::vector<Line> &lines, size_t i, ClipKernel kernel)
+{
+    float x1 = lines[i].p1.x, y1 = lines[i].p1.y, x2 = lines[i].p2.x, y2 = lines[i].p2.y;
+    cache.visible[i] = clipLine(kernel, x1, y1, x2, y2);
+    cache.clipped[i] = Line(Point(x1, y1), Point(x2, y2));
+    placeLine(cache, i);
+    cache.reclipped++;
+}
+
+struct ClipRect
+{
+    float x0, y0, x1, y1;
+};
+
+// Closed intersection of a and b; false if they do not meet
+inline bool intersectRects(const ClipRect &a, const ClipRect &b, ClipRect &r)
+{
+    r = {std::max(a.x0, b.x0), std::max(a.y0, b.y0), std::min(a.x1, b.x1), std::min(a.y1, b.y1)};
+    return r.x0 <= r.x1 && r.y0 <= r.y1;
+}
+
+// Whether box meets windows a and b in the same rectangle. A line inside box then clips
+// to the same segment against both, since only window edges crossing box are ever used
+inline bool sameOverlap(const ClipRect &box, const ClipRect &a, const ClipRect &b)
+{
+    ClipRect ra, rb;
+    bool ia = intersectRects(box, a, ra), ib = intersectRects(box, b, rb);
+    if (!ia || !ib)
+        return ia == ib;
+    return ra.x0 == rb.x0 && ra.y0 == rb.y0 && ra.x1 == rb.x1 && ra.y1 == rb.y1;
+}
+
+// Cover a \ b with up to 4 closed rectangles, appended to pieces
+inline void subtractRect(const ClipRect &a, const ClipRect &b, std::vector<ClipRect> &pieces)
+{
+    ClipRect overlap;
+    if (!intersectRects(a, b, overlap))
+    {
+        pieces.push_back(a);
+        return;
+    }
+    if (a.x0 < b.x0)
+        pieces.push_back({a.x0, a.y0, b.x0, a.y1});
+    if (b.x1 < a.x1)
+        pieces.push_back({b.x1, a.y0, a.x1, a.y1});
+    if (a.y0 < b.y0)
+        pieces.push_back({overlap.x0, a.y0, overlap.x1, b.y0});
+    if (b.y1 < a.y1)
+        pieces.push_back({overlap.x0, b.y1, overlap.x1, a.y1});
+}
+
+// Re-clip the first count lines after the window moved from old to the current one. Only
+// lines listed in grid cells touching the symmetric difference of the two windows, and the
+// loose ones, are looked at; of those only the ones whose boxes meet the windows
+// differently are clipped
+inline void reclipMovedWindow(ClipCache &cache, const std::vector<Line> &lines, size_t count, ClipKernel kernel)
+{
+    if (!cache.gridValid || cache.gridLines > lines.size() || cache.gridVersion != cache.linesVersion ||
+        cache.loose.size() > std::max<size_t>(1024, cache.gridLines / 32))
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        buildLineGrid(cache.grid, lines);
+        cache.gridValid = true;
+        cache.gridLines = lines.size();
+        cache.gridVersion = cache.linesVersion;
+        cache.loose.clear();
+        cache.isLoose.assign(lines.size(), 0);
+        cache.gridBuilds++;
+        cache.gridMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+    cache.grid.stamp.resize(lines.size(), 0);
+
+    ClipRect before = {cache.xMin, cache.yMin, cache.xMax, cache.yMax};
+    ClipRect after = {xMin, yMin, xMax, yMax};
+    std::vector<ClipRect> pieces;
+    subtractRect(before, after, pieces);
+    subtractRect(after, before, pieces);
+
+    // A loose line may still sit in the cells of its old box; the stamp keeps it to one test
+    auto visit = [&](uint32_t i)
+    {
+        if (i >= count)
+            return;
+        cache.candidates++;
+        const Line &l = lines[i];
+        ClipRect box = {std::min(l.p1.x, l.p2.x), std::min(l.p1.y, l.p2.y),
+                        std::max(l.p1.x, l.p2.x), std::max(l.p1.y, l.p2.y)};
+        if (!sameOverlap(box, before, after))
+            reclipLine(cache, lines, i, kernel);
+    };
+
+    beginGridQuery(cache.grid);
+    for (const ClipRect &piece : pieces)
+        visitGridRect(cache.grid, piece.x0, piece.y0, piece.x1, piece.y1, visit);
+    for (uint32_t i : cache.loose)
+    {
+        if (cache.grid.stamp[i] == cache.grid.query)
+            continue;
+        cache.grid.stamp[i] = cache.grid.query;
+        visit(i);
+    }
+}
+
+// Report an edit of lines[i]
+inline void invalidateLine(ClipCache &cache, size_t i)
+{
+    cache.dirty.push_back(static_cast<uint32_t>(i));
+}
+
+// Bring the cache up to date with lines (at version linesVersion) and the current window
+inline void updateClipCache(ClipCache &cache, const std::vector<Line> &lines, unsigned linesVersion, ClipKernel kernel)
+{
+    cache.reclipped = 0;
+    cache.candidates = 0;
+    cache.gridMs = 0.0;
+    size_t cached = cache.clipped.size();
+
+    bool full = !cache.valid || cache.linesVersion != linesVersion || cache.kernel != kernel || lines.size() < cached;
+    bool moved = cache.windowVersion != windowVersion;
+
+    // Appended and edited lines of the same set are missing from the grid, or listed under
+    // their old boxes; the grid goes on to serve the rest
+    if (cache.linesVersion == linesVersion)
+    {
+        for (size_t i = cached; i < lines.size(); i++)
+            loosenLine(cache, i);
+        for (uint32_t i : cache.dirty)
+            loosenLine(cache, i);
+    }
+
+    if (full)
+    {
+        cache.clipped.resize(lines.size());
+        cache.visible.resize(lines.size());
+        clipLinesIndexed(lines, 0, lines.size(), kernel, 0, cache.clipped, cache.visible);
+        cache.reclipped = lines.size();
+
+        cache.vertices.clear();
+        cache.slotLine.clear();
+        cache.slot.assign(lines.size(), NO_SLOT);
+        for (size_t i = 0; i < lines.size(); i++)
+            placeLine(cache, i);
+    }
+    else
+    {
+        if (lines.size() == cached && cache.dirty.empty() && !moved)
+            return;
+
+        if (moved)
+            reclipMovedWindow(cache, lines, cached, kernel);
+
+        // New lines at the end, then individually edited ones
+        cache.clipped.resize(lines.size());
+        cache.visible.resize(lines.size());
+        cache.slot.resize(lines.size(), NO_SLOT);
+        clipLinesIndexed(lines, cached, lines.size(), kernel, 0, cache.clipped, cache.visible);
+        cache.reclipped += lines.size() - cached;
+        for (size_t i = cached; i < lines.size(); i++)
+            placeLine(cache, i);
+        for (uint32_t i : cache.dirty)
+        {
+            if (i < cached)
+                reclipLine(cache, lines, i, kernel);
+        }
+    }
+
+    cache.dirty.clear();
+    cache.valid = true;
+    cache.windowVersion = windowVersion;
+    cache.linesVersion = linesVersion;
+    cache.kernel = kernel;
+    cache.xMin = xMin;
+    cache.yMin = yMin;
+    cache.xMax = xMax;
+    cache.yMax = yMax;
+}
+
+// Submit a whole line set in one call; a Line is its two endpoints' coordinates back to back
+inline void drawLineSet(const std::vector<Line> &lines)
+{
+    static_assert(sizeof(Line) == 4 * sizeof(float), "Line must be four packed floats");
+    if (lines.empty())
+        return;
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, lines.data());
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(lines.size() * 2));
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// Submit the visible segments in one call (and their endpoints in another if asked)
+inline void drawClipCache(const ClipCache &cache, bool endpoints = false)
+{
+    if (cache.vertices.empty())
+        return;
+
+    GLsizei count = static_cast<GLsizei>(cache.vertices.size() / 2);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, cache.vertices.data());
+    glDrawArrays(GL_LINES, 0, count);
+    if (endpoints)
+        glDrawArrays(GL_POINTS, 0, count);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// Drag a window across short segments in small steps, then edit some lines, timing the
+// incremental updates against re-clipping everything and checking the final state against the latter
+inline void benchmarkWindowDrag(size_t n, ClipKernel kernel)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<Line> lines, offsets;
+    uint32_t seed = 2024;
+    appendRandomLines(lines, n, seed, 3.0f);
+    appendRandomLines(offsets, n, seed, 0.05f);
+    for (size_t i = 0; i < n; i++)
+        lines[i].p2 = Point(lines[i].p1.x + offsets[i].p2.x, lines[i].p1.y + offsets[i].p2.y);
+
+    float saved[4] = {xMin, yMin, xMax, yMax};
+    xMin = yMin = -0.5f;
+    xMax = yMax = 0.5f;
+    windowVersion++;
+
+    ClipCache cache;
+    updateClipCache(cache, lines, 0, kernel);
+
+    // The first move builds the grid; leave that out of the timing
+    xMin += 0.001f;
+    windowVersion++;
+    updateClipCache(cache, lines, 0, kernel);
+
+    // Grid upkeep counts towards the frame: a rebuild would show up as the slowest step
+    const int STEPS = 60;
+    size_t reclipped = 0, candidates = 0;
+    double gridMs = 0.0, slowestMs = 0.0;
+    auto t0 = Clock::now();
+    for (int step = 0; step < STEPS; step++)
+    {
+        auto s0 = Clock::now();
+        // Move right and grow, as a drag on the lower right corner would
+        xMin += 0.01f;
+        xMax += 0.015f;
+        yMin -= 0.005f;
+        windowVersion++;
+        updateClipCache(cache, lines, 0, kernel);
+        reclipped += cache.reclipped;
+        candidates += cache.candidates;
+        gridMs += cache.gridMs;
+        slowestMs = std::max(slowestMs, std::chrono::duration<double, std::milli>(Clock::now() - s0).count());
+    }
+    auto t1 = Clock::now();
+
+    // Edit lines through invalidateLine, then move the window: the edited lines go on the
+    // side list, so the move after them must stay incremental and keep the grid
+    const size_t EDITS = 1000;
+    std::vector<Line> moved;
+    appendRandomLines(moved, EDITS, seed, 1.0f);
+    auto t4 = Clock::now();
+    for (size_t k = 0; k < EDITS; k++)
+    {
+        size_t i = (seed = seed * 1664525u + 1013904223u) % n;
+        lines[i] = moved[k];
+        invalidateLine(cache, i);
+    }
+    updateClipCache(cache, lines, 0, kernel);
+    size_t editReclipped = cache.reclipped;
+    auto t5 = Clock::now();
+
+    unsigned builds = cache.gridBuilds;
+    xMin -= 0.01f;
+    windowVersion++;
+    updateClipCache(cache, lines, 0, kernel);
+    auto t6 = Clock::now();
+    bool kept = cache.gridBuilds == builds;
+
+    std::vector<Line> clipped(n);
+    std::vector<uint8_t> visible(n);
+    auto t2 = Clock::now();
+    clipLinesIndexed(lines, 0, n, kernel, 0, clipped, visible);
+    auto t3 = Clock::now();
+
+    // Per-line results, and a vertex buffer holding exactly the visible ones
+    bool same = true;
+    size_t visibleCount = 0;
+    for (size_t i = 0; same && i < n; i++)
+    {
+        same = visible[i] == cache.visible[i] &&
+               (!visible[i] || (clipped[i].p1.x == cache.clipped[i].p1.x && clipped[i].p1.y == cache.clipped[i].p1.y &&
+                                clipped[i].p2.x == cache.clipped[i].p2.x && clipped[i].p2.y == cache.clipped[i].p2.y));
+        if (same && visible[i])
+        {
+            const float *v = &cache.vertices[static_cast<size_t>(cache.slot[i]) * 4];
+            same = cache.slotLine[cache.slot[i]] == i && v[0] == clipped[i].p1.x && v[1] == clipped[i].p1.y &&
+                   v[2] == clipped[i].p2.x && v[3] == clipped[i].p2.y;
+            visibleCount++;
+        }
+        else if (same)
+            same = cache.slot[i] == NO_SLOT;
+    }
+    same = same && cache.vertices.size() == visibleCount * 4;
+
+    std::cout << "Dragging a window over " << n << " segments (" << kernelName(kernel) << ")\n";
+    std::cout << "  Per step: " << std::chrono::duration<double, std::milli>(t1 - t0).count() / STEPS << " ms, "
+              << reclipped / STEPS << " re-clipped of " << candidates / STEPS << " looked at, "
+              << gridMs / STEPS << " ms on the grid, slowest step " << slowestMs << " ms\n";
+    std::cout << "  " << EDITS << " edited lines: " << std::chrono::duration<double, std::milli>(t5 - t4).count()
+              << " ms, " << editReclipped << " re-clipped; the move after them: "
+              << std::chrono::duration<double, std::milli>(t6 - t5).count() << " ms, " << cache.reclipped
+              << " re-clipped, " << (kept ? "grid kept" : "GRID REBUILT") << " (" << cache.gridMs
+              << " ms on the grid)\n";
+    std::cout << "  Full re-clip: " << std::chrono::duration<double, std::milli>(t3 - t2).count() << " ms, "
+              << (same ? "same result" : "RESULT DIFFERS") << "\n";
+
+    xMin = saved[0];
+    yMin = saved[1];
+    xMax = saved[2];
+    yMax = saved[3];
+    windowVersion++;
+}
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef CLIPENGINE_H
+#define CLIPENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+#include "LineClip.h"
+
+// Multi-threaded clipping of large line sets against the current window.
+// The input is cut into fixed-size chunks and every thread starts with an equal run
+// of them. A thread takes chunks from the front of its own run and, once that is
+// empty, steals from the back of another thread's run, so slow threads do not hold
+// up the rest. Survivors go to per-thread buffers; afterwards a prefix sum over the
+// per-chunk counts gives every chunk its place in the output, and each thread copies
+// its own chunks there. Nothing is locked and the output keeps the input order
+enum ClipKernel
+{
+    KERNEL_COHEN_SUTHERLAND,
+    KERNEL_LIANG_BARSKY,
+    KERNEL_NICHOLL_LEE_NICHOLL,
+    KERNEL_COUNT
+};
+
+inline const char *kernelName(ClipKernel kernel)
+{
+    static const char *names[KERNEL_COUNT] = {"Cohen-Sutherland", "Liang-Barsky", "Nicholl-Lee-Nicholl"};
+    return names[kernel];
+}
+
+// The kernel after this one, for cycling through them from the keyboard
+inline ClipKernel nextKernel(ClipKernel kernel)
+{
+    return static_cast<ClipKernel>((kernel + 1) % KERNEL_COUNT);
+}
+
+inline bool clipLine(ClipKernel kernel, float &x1, float &y1, float &x2, float &y2)
+{
+    switch (kernel)
+    {
+    case KERNEL_COHEN_SUTHERLAND:
+        return cohenSutherlandClip(x1, y1, x2, y2);
+    case KERNEL_LIANG_BARSKY:
+        return liangBarskyClip(x1, y1, x2, y2);
+    default:
+        return nichollLeeNichollClip(x1, y1, x2, y2);
+    }
+}
+
+const size_t CLIP_CHUNK = 4096;
+
+// A thread's remaining chunks [front, back), packed so both ends move with one CAS
+struct alignas(64) ChunkRun
+{
+    std::atomic<uint64_t> range;
+
+    void set(uint32_t front, uint32_t back)
+    {
+        range.store(static_cast<uint64_t>(back) << 32 | front);
+    }
+
+    bool takeFront(uint32_t &chunk)
+    {
+        uint64_t r = range.load();
+        while (true)
+        {
+            uint32_t front = static_cast<uint32_t>(r), back = static_cast<uint32_t>(r >> 32);
+            if (front >= back)
+                return false;
+            if (range.compare_exchange_weak(r, static_cast<uint64_t>(back) << 32 | (front + 1)))
+            {
+                chunk = front;
+                return true;
+            }
+        }
+    }
+
+    bool stealBack(uint32_t &chunk)
+    {
+        uint64_t r = range.load();
+        while (true)
+        {
+            uint32_t front = static_cast<uint32_t>(r), back = static_cast<uint32_t>(r >> 32);
+            if (front >= back)
+                return false;
+            if (range.compare_exchange_weak(r, static_cast<uint64_t>(back - 1) << 32 | front))
+            {
+                chunk = back - 1;
+                return true;
+            }
+        }
+    }
+};
+
+struct ClipStats
+{
+    size_t chunks = 0;
+    size_t stolen = 0; // Chunks processed by a thread other than their owner
+};
+
+// Run fn(t) on threads 0 .. threads - 1, thread 0 being the caller
+template <typename Fn>
+void runThreads(size_t threads, Fn fn)
+{
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++)
+        workers.emplace_back(fn, t);
+    fn(0);
+    for (auto &w : workers)
+        w.join();
+}
+
+// Call fn(t, chunk) for every chunk, scheduled by work stealing; returns the thread count used
+template <typename Fn>
+size_t runChunks(size_t chunks, size_t threads, Fn fn, ClipStats *stats = nullptr)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min(threads, chunks));
+
+    std::vector<ChunkRun> runs(threads);
+    for (size_t t = 0; t < threads; t++)
+        runs[t].set(static_cast<uint32_t>(chunks * t / threads), static_cast<uint32_t>(chunks * (t + 1) / threads));
+
+    std::atomic<size_t> stolen(0);
+    runThreads(threads, [&](size_t t)
+               {
+                   uint32_t chunk;
+                   while (runs[t].takeFront(chunk))
+                       fn(t, chunk);
+
+                   // Own run is empty: steal until every run is
+                   size_t local = 0;
+                   for (size_t k = 1; k < threads; k++)
+                   {
+                       ChunkRun &victim = runs[(t + k) % threads];
+                       while (victim.stealBack(chunk))
+                       {
+                           fn(t, chunk);
+                           local++;
+                       }
+                   }
+                   stolen += local; });
+
+    if (stats)
+    {
+        stats->chunks = chunks;
+        stats->stolen = stolen;
+    }
+    return threads;
+}
+
+// Clip in with the chosen kernel on the given number of threads (0 = all cores)
+inline size_t clipLines(const std::vector<Line> &in, ClipKernel kernel, size_t threads,
+                        std::vector<Line> &out, ClipStats *stats = nullptr)
+{
+    size_t chunks = (in.size() + CLIP_CHUNK - 1) / CLIP_CHUNK;
+    size_t used = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    used = std::max<size_t>(1, std::min(used, chunks));
+
+    // Where each chunk's survivors sit in the buffer of the thread that clipped it
+    std::vector<uint32_t> chunkThread(chunks), chunkBegin(chunks), chunkCount(chunks);
+    std::vector<std::vector<Line>> buffers(used);
+
+    auto clipChunk = [&](size_t t, uint32_t chunk)
+    {
+        std::vector<Line> &buffer = buffers[t];
+        size_t begin = chunk * CLIP_CHUNK, end = std::min(in.size(), begin + CLIP_CHUNK);
+        chunkThread[chunk] = static_cast<uint32_t>(t);
+        chunkBegin[chunk] = static_cast<uint32_t>(buffer.size());
+        for (size_t i = begin; i < end; i++)
+        {
+            float x1 = in[i].p1.x, y1 = in[i].p1.y, x2 = in[i].p2.x, y2 = in[i].p2.y;
+            if (clipLine(kernel, x1, y1, x2, y2))
+                buffer.emplace_back(Point(x1, y1), Point(x2, y2));
+        }
+        chunkCount[chunk] = static_cast<uint32_t>(buffer.size() - chunkBegin[chunk]);
+    };
+
+    runChunks(chunks, used, clipChunk, stats);
+
+    // Exclusive prefix sum of the chunk counts gives each chunk's output offset
+    std::vector<size_t> offset(chunks + 1, 0);
+    for (size_t c = 0; c < chunks; c++)
+        offset[c + 1] = offset[c] + chunkCount[c];
+    out.resize(offset[chunks]);
+
+    runThreads(used, [&](size_t t)
+               {
+                   for (size_t c = 0; c < chunks; c++)
+                   {
+                       if (chunkThread[c] == t)
+                           std::copy_n(buffers[t].begin() + chunkBegin[c], chunkCount[c], out.begin() + offset[c]);
+                   } });
+    return out.size();
+}
+
+// Clip lines [begin, end) in place of their per-line results: clipped[i] holds the clipped
+// copy of in[i] and visible[i] whether anything is left. Used by callers that keep results
+// per input line, so no merge is needed
+inline void clipLinesIndexed(const std::vector<Line> &in, size_t begin, size_t end, ClipKernel kernel,
+                             size_t threads, std::vector<Line> &clipped, std::vector<uint8_t> &visible)
+{
+    size_t chunks = (end - begin + CLIP_CHUNK - 1) / CLIP_CHUNK;
+    runChunks(chunks, threads, [&](size_t, uint32_t chunk)
+              {
+                  size_t first = begin + chunk * CLIP_CHUNK, last = std::min(end, first + CLIP_CHUNK);
+                  for (size_t i = first; i < last; i++)
+                  {
+                      float x1 = in[i].p1.x, y1 = in[i].p1.y, x2 = in[i].p2.x, y2 = in[i].p2.y;
+                      visible[i] = clipLine(kernel, x1, y1, x2, y2);
+                      clipped[i] = Line(Point(x1, y1), Point(x2, y2));
+                  } });
+}
+
+// Time clipLines with both kernels on 1, 2, 4, ... threads up to all cores, checking
+// every run against the single-threaded output
+inline void benchmarkClipEngine(size_t n)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<Line> in;
+    uint32_t seed = 12345;
+    appendRandomLines(in, n, seed);
+
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Clipping " << n << " lines on up to " << cores << " threads\n";
+
+    for (ClipKernel kernel : {KERNEL_COHEN_SUTHERLAND, KERNEL_LIANG_BARSKY, KERNEL_NICHOLL_LEE_NICHOLL})
+    {
+        std::vector<Line> reference, out;
+        double baseMs = 0.0;
+        for (size_t threads = 1;; threads = std::min(threads * 2, cores))
+        {
+            ClipStats stats;
+            double best = 1e30;
+            for (int run = 0; run < 3; run++)
+            {
+                auto t0 = Clock::now();
+                clipLines(in, kernel, threads, out, &stats);
+                auto t1 = Clock::now();
+                best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+            }
+
+            bool same = true;
+            if (threads == 1)
+            {
+                reference = out;
+                baseMs = best;
+            }
+            else
+            {
+                same = out.size() == reference.size();
+                for (size_t i = 0; same && i < out.size(); i++)
+                    same = out[i].p1.x == reference[i].p1.x && out[i].p1.y == reference[i].p1.y &&
+                           out[i].p2.x == reference[i].p2.x && out[i].p2.y == reference[i].p2.y;
+            }
+
+            std::cout << "  " << kernelName(kernel) << ", " << threads << " thread(s): " << best << " ms, speedup "
+                      << baseMs / best << "x, " << stats.stolen << " of " << stats.chunks << " chunks stolen"
+                      << (same ? "" : ", OUTPUT DIFFERS") << "\n";
+            if (threads == cores)
+                break;
+        }
+    }
+}
+
+// Time the three kernels one line at a time on lines with both endpoints inside the window,
+// both outside it, and one on each side. Every output is checked against Liang-Barsky:
+// the same lines must survive, with endpoints that agree up to rounding
+inline void benchmarkKernels(size_t n)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const char *mixNames[3] = {"inside", "outside", "crossing"};
+    std::vector<Line> mixes[3];
+    uint32_t seed = 77;
+    std::vector<Line> candidates;
+    while (mixes[0].size() < n || mixes[1].size() < n || mixes[2].size() < n)
+    {
+        candidates.clear();
+        appendRandomLines(candidates, 4096, seed, 1.5f);
+        for (const Line &l : candidates)
+        {
+            bool in1 = computeCode(l.p1.x, l.p1.y) == INSIDE, in2 = computeCode(l.p2.x, l.p2.y) == INSIDE;
+            std::vector<Line> &mix = mixes[in1 && in2 ? 0 : (!in1 && !in2 ? 1 : 2)];
+            if (mix.size() < n)
+                mix.push_back(l);
+        }
+        // Lines with both ends inside are rare at this extent; shrink some into the window
+        for (const Line &l : candidates)
+        {
+            if (mixes[0].size() < n)
+                mixes[0].push_back(Line(Point(l.p1.x / 3.0f, l.p1.y / 3.0f), Point(l.p2.x / 3.0f, l.p2.y / 3.0f)));
+        }
+    }
+
+    std::cout << "Clipping " << n << " lines per mix, one at a time\n";
+    for (int m = 0; m < 3; m++)
+    {
+        std::vector<Line> reference;
+        std::cout << "  " << mixNames[m] << ":";
+        for (ClipKernel kernel : {KERNEL_LIANG_BARSKY, KERNEL_COHEN_SUTHERLAND, KERNEL_NICHOLL_LEE_NICHOLL})
+        {
+            std::vector<Line> out;
+            std::vector<uint8_t> visible;
+            double best = 1e30;
+            for (int run = 0; run < 3; run++)
+            {
+                out.assign(mixes[m].begin(), mixes[m].end());
+                visible.assign(n, 0);
+                auto t0 = Clock::now();
+                for (size_t i = 0; i < n; i++)
+                    visible[i] = clipLine(kernel, out[i].p1.x, out[i].p1.y, out[i].p2.x, out[i].p2.y);
+                best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                if (!visible[i])
+                    out[i] = Line(Point(NAN, NAN), Point(NAN, NAN));
+            }
+
+            std::cout << " " << kernelName(kernel) << " " << best << " ms";
+            if (kernel == KERNEL_LIANG_BARSKY)
+            {
+                reference = out;
+                continue;
+            }
+
+            size_t differing = 0;
+            float maxError = 0.0f;
+            for (size_t i = 0; i < n; i++)
+            {
+                const Line &a = reference[i], &b = out[i];
+                if (std::isnan(a.p1.x) != std::isnan(b.p1.x))
+                    differing++;
+                else if (!std::isnan(a.p1.x))
+                    maxError = std::max({maxError, std::fabs(a.p1.x - b.p1.x), std::fabs(a.p1.y - b.p1.y),
+                                         std::fabs(a.p2.x - b.p2.x), std::fabs(a.p2.y - b.p2.y)});
+            }
+            std::cout << " (";
+            if (differing)
+                std::cout << differing << " DIFFER, ";
+            std::cout << "max difference " << maxError << ")";
+        }
+        std::cout << "\n";
+    }
+}
+
+#endif
@@ -1,118 +1,191 @@
 #include <GL/glut.h>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <tuple>
 #include <vector>
 
-// Region codes for Cohen-Sutherland algorithm
-const int INSIDE = 0; // 0000
-const int LEFT = 1;   // 0001
-const int RIGHT = 2;  // 0010
-const int BOTTOM = 4; // 0100
-const int TOP = 8;    // 1000
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
-// Clipping window boundaries
-float xMin = -0.5f, yMin = -0.5f;
-float xMax = 0.5f, yMax = 0.5f;
+#include "LineClip.h"
+#include "ClipEngine.h"
+#include "ClipCache.h"
+#include "LineGrid.h"
+#include "WindowDrag.h"
 
-struct Point
+std::vector<Line> lines;
+unsigned linesVersion = 0; // Bumped when lines is replaced; appends are picked up on their own
+uint32_t lineSeed = 1;
+ClipCache clipCache;
+ClipKernel clipKernel = KERNEL_COHEN_SUTHERLAND;
+
+// How the lines of a batch were resolved
+struct ClipCounts
 {
-    float x, y;
-    Point(float px = 0, float py = 0) : x(px), y(py) {}
+    size_t accepted = 0; // Both endpoints inside
+    size_t rejected = 0; // Both endpoints outside the same boundary
+    size_t clipped = 0;  // Went through the iterative loop
+    size_t survived = 0; // Of the clipped ones, still visible afterwards
 };
 
-struct Line
+// A line left for the iterative loop, with the outcodes the pre-pass already computed
+struct PendingLine
 {
-    Point p1, p2;
-    Line(Point a, Point b) : p1(a), p2(b) {}
+    uint32_t index;
+    int code1, code2;
 };
 
-std::vector<Line> lines;
-
-// Compute region code for a point
-int computeCode(float x, float y)
+#ifdef __AVX2__
+// Outcodes of 8 points at once: each compare gives an all-ones lane that is masked
+// down to its region bit. The window is never empty, so LEFT/RIGHT (and BOTTOM/TOP)
+// cannot both be set, which matches the else-if in computeCode
+inline __m256i computeCodes8(__m256 x, __m256 y, __m256 vxMin, __m256 vyMin, __m256 vxMax, __m256 vyMax)
 {
-    int code = INSIDE;
-
-    if (x < xMin)
-        code |= LEFT;
-    else if (x > xMax)
-        code |= RIGHT;
-    if (y < yMin)
-        code |= BOTTOM;
-    else if (y > yMax)
-        code |= TOP;
-
-    return code;
+    __m256i left = _mm256_castps_si256(_mm256_cmp_ps(x, vxMin, _CMP_LT_OQ));
+    __m256i right = _mm256_castps_si256(_mm256_cmp_ps(x, vxMax, _CMP_GT_OQ));
+    __m256i bottom = _mm256_castps_si256(_mm256_cmp_ps(y, vyMin, _CMP_LT_OQ));
+    __m256i top = _mm256_castps_si256(_mm256_cmp_ps(y, vyMax, _CMP_GT_OQ));
+    __m256i code = _mm256_and_si256(left, _mm256_set1_epi32(LEFT));
+    code = _mm256_or_si256(code, _mm256_and_si256(right, _mm256_set1_epi32(RIGHT)));
+    code = _mm256_or_si256(code, _mm256_and_si256(bottom, _mm256_set1_epi32(BOTTOM)));
+    return _mm256_or_si256(code, _mm256_and_si256(top, _mm256_set1_epi32(TOP)));
 }
+#endif
 
-// Cohen-Sutherland line clipping algorithm
-bool cohenSutherlandClip(float &x1, float &y1, float &x2, float &y2)
+// Clip a whole batch. A pre-pass computes both outcodes of 8 lines at a time and sorts
+// them with two movemasks: trivially accepted lines are copied to out, trivially rejected
+// ones are dropped, and only the rest are compacted into pending for the iterative loop.
+// Accepted lines come first in out, followed by the clipped survivors
+ClipCounts cohenSutherlandClipBatch(const LineBatch &in, LineBatch &out, std::vector<PendingLine> &pending)
 {
-    int code1 = computeCode(x1, y1);
-    int code2 = computeCode(x2, y2);
-    bool accept = false;
+    ClipCounts counts;
+    size_t n = in.size();
+    out.clear();
+    pending.clear();
 
-    while (true)
+    auto classify = [&](size_t i, int code1, int code2)
     {
-        if ((code1 == 0) && (code2 == 0))
+        if ((code1 | code2) == 0)
         {
-            // Both points inside window
-            accept = true;
-            break;
+            out.push(in.x1[i], in.y1[i], in.x2[i], in.y2[i]);
+            counts.accepted++;
         }
         else if (code1 & code2)
+            counts.rejected++;
+        else
+            pending.push_back({static_cast<uint32_t>(i), code1, code2});
+    };
+
+    size_t i = 0;
+#ifdef __AVX2__
+    __m256 vxMin = _mm256_set1_ps(xMin), vyMin = _mm256_set1_ps(yMin);
+    __m256 vxMax = _mm256_set1_ps(xMax), vyMax = _mm256_set1_ps(yMax);
+    __m256i zero = _mm256_setzero_si256();
+    alignas(32) int code1[8], code2[8];
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i c1 = computeCodes8(_mm256_loadu_ps(&in.x1[i]), _mm256_loadu_ps(&in.y1[i]), vxMin, vyMin, vxMax, vyMax);
+        __m256i c2 = computeCodes8(_mm256_loadu_ps(&in.x2[i]), _mm256_loadu_ps(&in.y2[i]), vxMin, vyMin, vxMax, vyMax);
+        int acceptMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_or_si256(c1, c2), zero)));
+        int keepMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(c1, c2), zero)));
+
+        // The common case of 8 rejections costs nothing more
+        if (keepMask == 0)
         {
-            // Both points share an outside region - trivially reject
-            break;
+            counts.rejected += 8;
+            continue;
         }
-        else
+        if (acceptMask == 0xFF)
+        {
+            out.x1.insert(out.x1.end(), &in.x1[i], &in.x1[i] + 8);
+            out.y1.insert(out.y1.end(), &in.y1[i], &in.y1[i] + 8);
+            out.x2.insert(out.x2.end(), &in.x2[i], &in.x2[i] + 8);
+            out.y2.insert(out.y2.end(), &in.y2[i], &in.y2[i] + 8);
+            counts.accepted += 8;
+            continue;
+        }
+
+        _mm256_store_si256(reinterpret_cast<__m256i *>(code1), c1);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(code2), c2);
+        for (int lane = 0; lane < 8; lane++)
+            classify(i + lane, code1[lane], code2[lane]);
+    }
+#endif
+    for (; i < n; i++)
+        classify(i, computeCode(in.x1[i], in.y1[i]), computeCode(in.x2[i], in.y2[i]));
+
+    for (const PendingLine &line : pending)
+    {
+        float x1 = in.x1[line.index], y1 = in.y1[line.index];
+        float x2 = in.x2[line.index], y2 = in.y2[line.index];
+        if (cohenSutherlandClip(x1, y1, x2, y2, line.code1, line.code2))
+        {
+            out.push(x1, y1, x2, y2);
+            counts.survived++;
+        }
+    }
+    counts.clipped = pending.size();
+    return counts;
+}
+
+// Headless comparison of clipping one line at a time against the batched pre-pass,
+// on short random segments scattered well beyond the window like a GIS layer
+void benchmarkClipBatch(size_t n)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-3.0f, 3.0f), offset(-0.1f, 0.1f);
+    LineBatch in, serialOut, batchOut;
+    for (size_t i = 0; i < n; i++)
+    {
+        float x = position(rng), y = position(rng);
+        in.push(x, y, x + offset(rng), y + offset(rng));
+    }
+
+    std::vector<PendingLine> pending;
+    ClipCounts counts;
+    double serialMs = 1e30, batchMs = 1e30;
+    for (int run = 0; run < 5; run++)
+    {
+        auto t0 = Clock::now();
+        serialOut.clear();
+        for (size_t i = 0; i < n; i++)
         {
-            // Line needs clipping
-            int codeOut;
-            float x, y;
-
-            // Pick a point outside the window
-            codeOut = (code1 != 0) ? code1 : code2;
-
-            // Find intersection point using line equation
-            // y = y1 + slope * (x - x1), x = x1 + (1/slope) * (y - y1)
-            if (codeOut & TOP)
-            {
-                x = x1 + (x2 - x1) * (yMax - y1) / (y2 - y1);
-                y = yMax;
-            }
-            else if (codeOut & BOTTOM)
-            {
-                x = x1 + (x2 - x1) * (yMin - y1) / (y2 - y1);
-                y = yMin;
-            }
-            else if (codeOut & RIGHT)
-            {
-                y = y1 + (y2 - y1) * (xMax - x1) / (x2 - x1);
-                x = xMax;
-            }
-            else if (codeOut & LEFT)
-            {
-                y = y1 + (y2 - y1) * (xMin - x1) / (x2 - x1);
-                x = xMin;
-            }
-
-            // Replace point outside window with intersection point
-            if (codeOut == code1)
-            {
-                x1 = x;
-                y1 = y;
-                code1 = computeCode(x1, y1);
-            }
-            else
-            {
-                x2 = x;
-                y2 = y;
-                code2 = computeCode(x2, y2);
-            }
+            float x1 = in.x1[i], y1 = in.y1[i], x2 = in.x2[i], y2 = in.y2[i];
+            if (cohenSutherlandClip(x1, y1, x2, y2))
+                serialOut.push(x1, y1, x2, y2);
         }
+        auto t1 = Clock::now();
+        counts = cohenSutherlandClipBatch(in, batchOut, pending);
+        auto t2 = Clock::now();
+        serialMs = std::min(serialMs, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        batchMs = std::min(batchMs, std::chrono::duration<double, std::milli>(t2 - t1).count());
     }
 
-    return accept;
+    // Same segments, possibly in a different order
+    auto sorted = [](const LineBatch &b)
+    {
+        std::vector<std::tuple<float, float, float, float>> v;
+        for (size_t i = 0; i < b.size(); i++)
+            v.emplace_back(b.x1[i], b.y1[i], b.x2[i], b.y2[i]);
+        std::sort(v.begin(), v.end());
+        return v;
+    };
+    bool same = sorted(serialOut) == sorted(batchOut);
+
+    std::cout << "Clipping " << n << " segments\n";
+    std::cout << "  One at a time : " << serialMs << " ms (" << n / serialMs / 1000.0 << " M/s)\n";
+    std::cout << "  Batched       : " << batchMs << " ms (" << n / batchMs / 1000.0 << " M/s)\n";
+    std::cout << "  Trivially accepted " << counts.accepted * 100.0 / n << "%, trivially rejected "
+              << counts.rejected * 100.0 / n << "%, clipped " << counts.clipped * 100.0 / n << "% ("
+              << counts.survived << " visible)\n";
+    std::cout << "  Outputs " << (same ? "match" : "DIFFER") << " (" << batchOut.size() << " segments)\n";
 }
 
 void display()
@@ -132,30 +205,17 @@ void display()
     // Draw original lines in red (solid, not dotted)
     glLineWidth(2.0f);
     glColor3f(1.0f, 0.3f, 0.3f);
-    for (const auto &line : lines)
-    {
-        glBegin(GL_LINES);
-        glVertex2f(line.p1.x, line.p1.y);
-        glVertex2f(line.p2.x, line.p2.y);
-        glEnd();
-    }
+    drawLineSet(lines);
 
     // Draw clipped lines in green with same width
     glColor3f(0.2f, 1.0f, 0.4f);
     glLineWidth(2.0f);
-    for (const auto &line : lines)
-    {
-        float x1 = line.p1.x, y1 = line.p1.y;
-        float x2 = line.p2.x, y2 = line.p2.y;
-
-        if (cohenSutherlandClip(x1, y1, x2, y2))
-        {
-            glBegin(GL_LINES);
-            glVertex2f(x1, y1);
-            glVertex2f(x2, y2);
-            glEnd();
-        }
-    }
+    updateClipCache(clipCache, lines, linesVersion, clipKernel);
+    if (clipCache.reclipped > 0 || clipCache.candidates > 0)
+        std::cout << "Re-clipped " << clipCache.reclipped << " of " << lines.size() << " lines ("
+                  << clipCache.candidates << " looked at for the window move, " << clipCache.gridMs
+                  << " ms building the grid)\n";
+    drawClipCache(clipCache);
     glLineWidth(1.0f);
 
     glFlush();
@@ -184,10 +244,42 @@ void keyboard(unsigned char key, int x, int y)
     { // ESC key
         exit(0);
     }
+    if (key == 'n' || key == 'N')
+    {
+        appendRandomLines(lines, 1000, lineSeed);
+        std::cout << lines.size() << " lines\n";
+        glutPostRedisplay();
+    }
+    if ((key == 'e' || key == 'E') && !lines.empty())
+    {
+        // Move one line elsewhere; the cache re-clips only that line
+        std::vector<Line> moved;
+        appendRandomLines(moved, 1, lineSeed);
+        size_t i = lineSeed % lines.size();
+        lines[i] = moved[0];
+        invalidateLine(clipCache, i);
+        glutPostRedisplay();
+    }
+    if (key == 'k' || key == 'K')
+    {
+        clipKernel = nextKernel(clipKernel);
+        std::cout << "Clipping with " << kernelName(clipKernel) << "\n";
+        glutPostRedisplay();
+    }
 }
 
 int main(int argc, char **argv)
 {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        benchmarkClipBatch(4000000);
+        benchmarkClipEngine(4000000);
+        benchmarkKernels(2000000);
+        benchmarkLineGrid(4000000, KERNEL_COHEN_SUTHERLAND);
+        benchmarkWindowDrag(4000000, KERNEL_COHEN_SUTHERLAND);
+        return 0;
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(900, 600);
@@ -198,6 +290,8 @@ int main(int argc, char **argv)
 
     glutDisplayFunc(display);
     glutKeyboardFunc(keyboard);
+    glutMouseFunc(clipWindowMouse);
+    glutMotionFunc(clipWindowMotion);
 
     std::cout << "Cohen-Sutherland Line Clipping Algorithm\n";
     std::cout << "========================================\n";
@@ -208,7 +302,11 @@ int main(int argc, char **argv)
     std::cout << "  1. Line completely inside window\n";
     std::cout << "  2. Line partially inside/outside (crosses window)\n";
     std::cout << "  3. Line completely outside window\n";
-    std::cout << "\nPress ESC to exit\n";
+    std::cout << "\nPress K to cycle through Cohen-Sutherland, Liang-Barsky and Nicholl-Lee-Nicholl\n";
+    std::cout << "Drag the window to move it, drag an edge or corner to resize it\n";
+    std::cout << "Press N to add 1000 random lines\n";
+    std::cout << "Press E to move a random line\n";
+    std::cout << "Press ESC to exit\n";
 
     glutMainLoop();
     return 0;
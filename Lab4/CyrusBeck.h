@@ -0,0 +1,278 @@
+#ifndef CYRUSBECK_H
+#define CYRUSBECK_H
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "LineClip.h"
+
+// Cyrus-Beck clipping of lines against a convex polygon. For a line P(t) = P1 + t (P2 - P1)
+// and an edge through E with inward normal N, the line is inside where
+//   N . (P1 - E) + t N . (P2 - P1) >= 0
+// so every edge gives an entering bound on t (denominator > 0), a leaving bound (< 0), or,
+// for a parallel line, accepts or rejects it whole. Edge points and normals depend only on
+// the polygon and are computed once per polygon
+struct ConvexClipper
+{
+    size_t edges = 0;
+    // Point on each edge and its inward normal, padded to whole vectors with edges that
+    // never constrain anything (zero normal)
+    std::vector<float> px, py, nx, ny;
+};
+
+// Prepare polygon (convex, either winding) for clipping
+template <typename P>
+void buildConvexClipper(ConvexClipper &clipper, const std::vector<P> &polygon)
+{
+    size_t n = polygon.size();
+    float area = 0.0f;
+    for (size_t i = 0; i < n; i++)
+    {
+        const P &a = polygon[i], &b = polygon[i + 1 == n ? 0 : i + 1];
+        area += a.x * b.y - b.x * a.y;
+    }
+    float side = area < 0.0f ? -1.0f : 1.0f; // Inside is to the left of counter-clockwise edges
+
+    size_t padded = (n + 7) / 8 * 8;
+    clipper.edges = n;
+    clipper.px.assign(padded, 0.0f);
+    clipper.py.assign(padded, 0.0f);
+    clipper.nx.assign(padded, 0.0f);
+    clipper.ny.assign(padded, 0.0f);
+    for (size_t i = 0; i < n; i++)
+    {
+        const P &a = polygon[i], &b = polygon[i + 1 == n ? 0 : i + 1];
+        clipper.px[i] = a.x;
+        clipper.py[i] = a.y;
+        clipper.nx[i] = -(b.y - a.y) * side;
+        clipper.ny[i] = (b.x - a.x) * side;
+    }
+}
+
+// Clip one line; the dot products of up to 8 edges are evaluated at once
+inline bool cyrusBeckClip(const ConvexClipper &clipper, float &x1, float &y1, float &x2, float &y2)
+{
+    float dx = x2 - x1, dy = y2 - y1;
+    float tEnter = 0.0f, tLeave = 1.0f;
+    size_t e = 0;
+
+#ifdef __AVX2__
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 vx1 = _mm256_set1_ps(x1), vy1 = _mm256_set1_ps(y1);
+    __m256 vdx = _mm256_set1_ps(dx), vdy = _mm256_set1_ps(dy);
+    __m256 enter = zero, leave = _mm256_set1_ps(1.0f), outside = zero;
+    for (; e < clipper.edges; e += 8)
+    {
+        __m256 nx = _mm256_loadu_ps(&clipper.nx[e]), ny = _mm256_loadu_ps(&clipper.ny[e]);
+        __m256 num = _mm256_add_ps(_mm256_mul_ps(nx, _mm256_sub_ps(vx1, _mm256_loadu_ps(&clipper.px[e]))),
+                                   _mm256_mul_ps(ny, _mm256_sub_ps(vy1, _mm256_loadu_ps(&clipper.py[e]))));
+        __m256 den = _mm256_add_ps(_mm256_mul_ps(nx, vdx), _mm256_mul_ps(ny, vdy));
+
+        // Parallel and padding lanes divide by zero, but the blends never pick them
+        __m256 t = _mm256_div_ps(_mm256_sub_ps(zero, num), den);
+        enter = _mm256_blendv_ps(enter, _mm256_max_ps(enter, t), _mm256_cmp_ps(den, zero, _CMP_GT_OQ));
+        leave = _mm256_blendv_ps(leave, _mm256_min_ps(leave, t), _mm256_cmp_ps(den, zero, _CMP_LT_OQ));
+        outside = _mm256_or_ps(outside, _mm256_and_ps(_mm256_cmp_ps(den, zero, _CMP_EQ_OQ),
+                                                      _mm256_cmp_ps(num, zero, _CMP_LT_OQ)));
+    }
+    if (_mm256_movemask_ps(outside))
+        return false;
+
+    // Fold the 8 lanes down to one
+    __m128 enter4 = _mm_max_ps(_mm256_castps256_ps128(enter), _mm256_extractf128_ps(enter, 1));
+    __m128 leave4 = _mm_min_ps(_mm256_castps256_ps128(leave), _mm256_extractf128_ps(leave, 1));
+    enter4 = _mm_max_ps(enter4, _mm_movehl_ps(enter4, enter4));
+    leave4 = _mm_min_ps(leave4, _mm_movehl_ps(leave4, leave4));
+    tEnter = _mm_cvtss_f32(_mm_max_ss(enter4, _mm_shuffle_ps(enter4, enter4, 1)));
+    tLeave = _mm_cvtss_f32(_mm_min_ss(leave4, _mm_shuffle_ps(leave4, leave4, 1)));
+#endif
+
+    for (; e < clipper.edges; e++)
+    {
+        float num = clipper.nx[e] * (x1 - clipper.px[e]) + clipper.ny[e] * (y1 - clipper.py[e]);
+        float den = clipper.nx[e] * dx + clipper.ny[e] * dy;
+        if (den == 0.0f)
+        {
+            if (num < 0.0f)
+                return false;
+        }
+        else if (den > 0.0f)
+            tEnter = std::max(tEnter, -num / den);
+        else
+            tLeave = std::min(tLeave, -num / den);
+    }
+
+    if (tEnter > tLeave)
+        return false;
+
+    float clippedX1 = x1 + tEnter * dx, clippedY1 = y1 + tEnter * dy;
+    x2 = x1 + tLeave * dx;
+    y2 = y1 + tLeave * dy;
+    x1 = clippedX1;
+    y1 = clippedY1;
+    return true;
+}
+
+// Clip a batch of lines, 8 lines per vector with each edge broadcast over them, which keeps
+// every lane busy however few edges the polygon has. Survivors go to out in input order
+inline size_t cyrusBeckClipBatch(const ConvexClipper &clipper, const LineBatch &in, LineBatch &out)
+{
+    size_t n = in.size();
+    out.clear();
+    size_t i = 0;
+
+#ifdef __AVX2__
+    const __m256 zero = _mm256_setzero_ps();
+    alignas(32) float cx1[8], cy1[8], cx2[8], cy2[8];
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 x1 = _mm256_loadu_ps(&in.x1[i]), y1 = _mm256_loadu_ps(&in.y1[i]);
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(&in.x2[i]), x1);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(&in.y2[i]), y1);
+
+        __m256 enter = zero, leave = _mm256_set1_ps(1.0f), outside = zero;
+        for (size_t e = 0; e < clipper.edges; e++)
+        {
+            __m256 nx = _mm256_set1_ps(clipper.nx[e]), ny = _mm256_set1_ps(clipper.ny[e]);
+            __m256 num = _mm256_add_ps(_mm256_mul_ps(nx, _mm256_sub_ps(x1, _mm256_set1_ps(clipper.px[e]))),
+                                       _mm256_mul_ps(ny, _mm256_sub_ps(y1, _mm256_set1_ps(clipper.py[e]))));
+            __m256 den = _mm256_add_ps(_mm256_mul_ps(nx, dx), _mm256_mul_ps(ny, dy));
+            __m256 t = _mm256_div_ps(_mm256_sub_ps(zero, num), den);
+            enter = _mm256_blendv_ps(enter, _mm256_max_ps(enter, t), _mm256_cmp_ps(den, zero, _CMP_GT_OQ));
+            leave = _mm256_blendv_ps(leave, _mm256_min_ps(leave, t), _mm256_cmp_ps(den, zero, _CMP_LT_OQ));
+            outside = _mm256_or_ps(outside, _mm256_and_ps(_mm256_cmp_ps(den, zero, _CMP_EQ_OQ),
+                                                          _mm256_cmp_ps(num, zero, _CMP_LT_OQ)));
+        }
+
+        int mask = _mm256_movemask_ps(_mm256_andnot_ps(outside, _mm256_cmp_ps(enter, leave, _CMP_LE_OQ)));
+        if (mask == 0)
+            continue;
+        _mm256_store_ps(cx1, _mm256_add_ps(x1, _mm256_mul_ps(enter, dx)));
+        _mm256_store_ps(cy1, _mm256_add_ps(y1, _mm256_mul_ps(enter, dy)));
+        _mm256_store_ps(cx2, _mm256_add_ps(x1, _mm256_mul_ps(leave, dx)));
+        _mm256_store_ps(cy2, _mm256_add_ps(y1, _mm256_mul_ps(leave, dy)));
+        for (; mask; mask &= mask - 1)
+        {
+            int lane = countTrailingZeros(mask);
+            out.push(cx1[lane], cy1[lane], cx2[lane], cy2[lane]);
+        }
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        float x1 = in.x1[i], y1 = in.y1[i], x2 = in.x2[i], y2 = in.y2[i];
+        if (cyrusBeckClip(clipper, x1, y1, x2, y2))
+            out.push(x1, y1, x2, y2);
+    }
+    return out.size();
+}
+
+// Headless comparison on random lines: against the current rectangular window, Cyrus-Beck
+// with the window as a polygon next to the rectangle clippers; then against a rotated
+// octagon, one line at a time against the batch
+inline void benchmarkCyrusBeck(size_t n)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<Line> lines;
+    uint32_t seed = 31;
+    appendRandomLines(lines, n, seed);
+    LineBatch in;
+    for (const Line &l : lines)
+        in.push(l.p1.x, l.p1.y, l.p2.x, l.p2.y);
+
+    // Best of 3 runs of clip over all lines, with the survivors left in out
+    auto time = [&](LineBatch &out, auto clip)
+    {
+        double best = 1e30;
+        for (int run = 0; run < 3; run++)
+        {
+            auto t0 = Clock::now();
+            out.clear();
+            clip(out);
+            best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+        }
+        return best;
+    };
+    auto perLine = [&](auto clip)
+    {
+        return [&in, clip](LineBatch &out)
+        {
+            for (size_t i = 0; i < in.size(); i++)
+            {
+                float x1 = in.x1[i], y1 = in.y1[i], x2 = in.x2[i], y2 = in.y2[i];
+                if (clip(x1, y1, x2, y2))
+                    out.push(x1, y1, x2, y2);
+            }
+        };
+    };
+    auto maxDifference = [](const LineBatch &a, const LineBatch &b)
+    {
+        if (a.size() != b.size())
+            return INFINITY;
+        float d = 0.0f;
+        for (size_t i = 0; i < a.size(); i++)
+            d = std::max({d, std::fabs(a.x1[i] - b.x1[i]), std::fabs(a.y1[i] - b.y1[i]),
+                          std::fabs(a.x2[i] - b.x2[i]), std::fabs(a.y2[i] - b.y2[i])});
+        return d;
+    };
+
+    ConvexClipper rectangle;
+    buildConvexClipper(rectangle, std::vector<Point>{Point(xMin, yMin), Point(xMax, yMin), Point(xMax, yMax), Point(xMin, yMax)});
+    LineBatch lbOut, csOut, cbOut, cbBatchOut;
+    double lbMs = time(lbOut, perLine([](float &a, float &b, float &c, float &d)
+                                      { return liangBarskyClip(a, b, c, d); }));
+    double csMs = time(csOut, perLine([](float &a, float &b, float &c, float &d)
+                                      { return cohenSutherlandClip(a, b, c, d); }));
+    double cbMs = time(cbOut, perLine([&rectangle](float &a, float &b, float &c, float &d)
+                                      { return cyrusBeckClip(rectangle, a, b, c, d); }));
+    double cbBatchMs = time(cbBatchOut, [&](LineBatch &out)
+                            { cyrusBeckClipBatch(rectangle, in, out); });
+
+    std::cout << "Clipping " << n << " lines against the window (" << lbOut.size() << " visible)\n";
+    std::cout << "  liangBarskyClip     : " << lbMs << " ms\n";
+    std::cout << "  cohenSutherlandClip : " << csMs << " ms\n";
+    std::cout << "  cyrusBeckClip       : " << cbMs << " ms, max difference to Liang-Barsky "
+              << maxDifference(lbOut, cbOut) << "\n";
+    std::cout << "  cyrusBeckClipBatch  : " << cbBatchMs << " ms, max difference to Liang-Barsky "
+              << maxDifference(lbOut, cbBatchOut) << "\n";
+
+    std::vector<Point> octagon;
+    for (int k = 0; k < 8; k++)
+    {
+        float angle = 0.3f + k * 3.14159265f / 4.0f;
+        octagon.push_back(Point(0.6f * std::cos(angle), 0.6f * std::sin(angle)));
+    }
+    ConvexClipper rotated;
+    buildConvexClipper(rotated, octagon);
+    cbMs = time(cbOut, perLine([&rotated](float &a, float &b, float &c, float &d)
+                               { return cyrusBeckClip(rotated, a, b, c, d); }));
+    cbBatchMs = time(cbBatchOut, [&](LineBatch &out)
+                     { cyrusBeckClipBatch(rotated, in, out); });
+
+    // Every clipped endpoint must lie inside the octagon, up to rounding
+    float worst = 0.0f;
+    for (size_t i = 0; i < cbBatchOut.size(); i++)
+    {
+        for (size_t e = 0; e < rotated.edges; e++)
+        {
+            float length = std::hypot(rotated.nx[e], rotated.ny[e]);
+            float d1 = (rotated.nx[e] * (cbBatchOut.x1[i] - rotated.px[e]) + rotated.ny[e] * (cbBatchOut.y1[i] - rotated.py[e])) / length;
+            float d2 = (rotated.nx[e] * (cbBatchOut.x2[i] - rotated.px[e]) + rotated.ny[e] * (cbBatchOut.y2[i] - rotated.py[e])) / length;
+            worst = std::max({worst, -d1, -d2});
+        }
+    }
+
+    std::cout << "Clipping " << n << " lines against a rotated octagon (" << cbOut.size() << " visible)\n";
+    std::cout << "  cyrusBeckClip       : " << cbMs << " ms\n";
+    std::cout << "  cyrusBeckClipBatch  : " << cbBatchMs << " ms, max difference " << maxDifference(cbOut, cbBatchOut)
+              << ", furthest endpoint outside " << worst << "\n";
+}
+
+#endif
@@ -2,91 +2,396 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "LineClip.h"
+#include "ClipEngine.h"
+#include "ClipCache.h"
+#include "LineGrid.h"
+#include "WindowDrag.h"
 
-// Clipping window boundaries
-float xMin = -0.5f, yMin = -0.5f;
-float xMax = 0.5f, yMax = 0.5f;
-
-struct Point
+std::vector<Line> lines;
+unsigned linesVersion = 0; // Bumped when lines is replaced; appends are picked up on their own
+uint32_t lineSeed = 1;
+ClipCache clipCache;
+ClipKernel clipKernel = KERNEL_LIANG_BARSKY;
+
+#ifdef __AVX2__
+// For each 8-bit lane mask, the permutation that moves the selected lanes to the front
+struct CompactTable
 {
-    float x, y;
-    Point(float px = 0, float py = 0) : x(px), y(py) {}
+    alignas(32) int32_t perm[256][8];
+    int count[256];
+
+    CompactTable()
+    {
+        for (int mask = 0; mask < 256; mask++)
+        {
+            int k = 0;
+            for (int lane = 0; lane < 8; lane++)
+            {
+                if (mask & (1 << lane))
+                    perm[mask][k++] = lane;
+            }
+            count[mask] = k;
+            while (k < 8)
+                perm[mask][k++] = 0;
+        }
+    }
 };
+#endif
+
+// Clip a batch of lines, 8 at a time without branches: all four q/p ratios are computed
+// for every lane, entering ratios (p < 0) are folded into u1 with max and leaving ones
+// (p > 0) into u2 with min through blends, and a lane parallel to a boundary (p == 0)
+// that lies outside it (q < 0) is masked out. Surviving segments are packed to the
+// front of out in input order; the return value is their count
+size_t liangBarskyClipBatch(const LineBatch &in, LineBatch &out)
+{
+    size_t n = in.size();
+    out.resize(n + 8); // Compacted stores write a full vector past the last survivor
+    size_t count = 0;
+    size_t i = 0;
+
+#ifdef __AVX2__
+    static const CompactTable table;
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    const __m256 vxMin = _mm256_set1_ps(xMin), vyMin = _mm256_set1_ps(yMin);
+    const __m256 vxMax = _mm256_set1_ps(xMax), vyMax = _mm256_set1_ps(yMax);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 x1 = _mm256_loadu_ps(&in.x1[i]), y1 = _mm256_loadu_ps(&in.y1[i]);
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(&in.x2[i]), x1);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(&in.y2[i]), y1);
 
-struct Line
+        const __m256 p[4] = {_mm256_sub_ps(zero, dx), dx, _mm256_sub_ps(zero, dy), dy};
+        const __m256 q[4] = {_mm256_sub_ps(x1, vxMin), _mm256_sub_ps(vxMax, x1),
+                             _mm256_sub_ps(y1, vyMin), _mm256_sub_ps(vyMax, y1)};
+
+        __m256 u1 = zero, u2 = one, outside = zero;
+        for (int k = 0; k < 4; k++)
+        {
+            // Division by zero lanes produce inf/nan, but the blends below never pick them
+            __m256 r = _mm256_div_ps(q[k], p[k]);
+            __m256 entering = _mm256_cmp_ps(p[k], zero, _CMP_LT_OQ);
+            __m256 leaving = _mm256_cmp_ps(p[k], zero, _CMP_GT_OQ);
+            __m256 parallel = _mm256_cmp_ps(p[k], zero, _CMP_EQ_OQ);
+            u1 = _mm256_blendv_ps(u1, _mm256_max_ps(u1, r), entering);
+            u2 = _mm256_blendv_ps(u2, _mm256_min_ps(u2, r), leaving);
+            outside = _mm256_or_ps(outside, _mm256_and_ps(parallel, _mm256_cmp_ps(q[k], zero, _CMP_LT_OQ)));
+        }
+
+        __m256 visible = _mm256_andnot_ps(outside, _mm256_cmp_ps(u1, u2, _CMP_LE_OQ));
+        int mask = _mm256_movemask_ps(visible);
+        if (mask == 0)
+            continue;
+
+        __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i *>(table.perm[mask]));
+        auto pack = [&](float *dst, __m256 v)
+        { _mm256_storeu_ps(dst + count, _mm256_permutevar8x32_ps(v, perm)); };
+        pack(out.x1.data(), _mm256_add_ps(x1, _mm256_mul_ps(u1, dx)));
+        pack(out.y1.data(), _mm256_add_ps(y1, _mm256_mul_ps(u1, dy)));
+        pack(out.x2.data(), _mm256_add_ps(x1, _mm256_mul_ps(u2, dx)));
+        pack(out.y2.data(), _mm256_add_ps(y1, _mm256_mul_ps(u2, dy)));
+        count += table.count[mask];
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        float x1 = in.x1[i], y1 = in.y1[i], x2 = in.x2[i], y2 = in.y2[i];
+        if (liangBarskyClip(x1, y1, x2, y2))
+        {
+            out.x1[count] = x1;
+            out.y1[count] = y1;
+            out.x2[count] = x2;
+            out.y2[count] = y2;
+            count++;
+        }
+    }
+
+    out.resize(count);
+    return count;
+}
+
+// Headless comparison of liangBarskyClip per line against the batch clipper on a mix of
+// inside, crossing, outside and axis-parallel segments
+void benchmarkClipBatch(size_t n)
 {
-    Point p1, p2;
-    Line(Point a, Point b) : p1(a), p2(b) {}
-};
+    typedef std::chrono::steady_clock Clock;
 
-std::vector<Line> lines;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    LineBatch in, serialOut, batchOut;
+    for (size_t i = 0; i < n; i++)
+    {
+        float x1 = position(rng), y1 = position(rng), x2 = position(rng), y2 = position(rng);
+        if (i % 16 == 0)
+            x2 = x1; // Vertical
+        else if (i % 16 == 1)
+            y2 = y1; // Horizontal
+        in.push(x1, y1, x2, y2);
+    }
+
+    double serialMs = 1e30, batchMs = 1e30;
+    for (int run = 0; run < 5; run++)
+    {
+        auto t0 = Clock::now();
+        serialOut.clear();
+        for (size_t i = 0; i < n; i++)
+        {
+            float x1 = in.x1[i], y1 = in.y1[i], x2 = in.x2[i], y2 = in.y2[i];
+            if (liangBarskyClip(x1, y1, x2, y2))
+                serialOut.push(x1, y1, x2, y2);
+        }
+        auto t1 = Clock::now();
+        liangBarskyClipBatch(in, batchOut);
+        auto t2 = Clock::now();
+        serialMs = std::min(serialMs, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        batchMs = std::min(batchMs, std::chrono::duration<double, std::milli>(t2 - t1).count());
+    }
+
+    float maxError = 0.0f;
+    bool sameCount = serialOut.size() == batchOut.size();
+    for (size_t i = 0; sameCount && i < serialOut.size(); i++)
+    {
+        maxError = std::max({maxError, std::fabs(serialOut.x1[i] - batchOut.x1[i]), std::fabs(serialOut.y1[i] - batchOut.y1[i]),
+                             std::fabs(serialOut.x2[i] - batchOut.x2[i]), std::fabs(serialOut.y2[i] - batchOut.y2[i])});
+    }
+
+    std::cout << "Clipping " << n << " segments (" << serialOut.size() << " visible)\n";
+    std::cout << "  liangBarskyClip      : " << serialMs << " ms (" << n / serialMs / 1000.0 << " M/s)\n";
+    std::cout << "  liangBarskyClipBatch : " << batchMs << " ms (" << n / batchMs / 1000.0 << " M/s)\n";
+    if (sameCount)
+        std::cout << "  Same segments, max difference " << maxError << "\n";
+    else
+        std::cout << "  Visible counts DIFFER: " << batchOut.size() << " batched\n";
+}
 
-// Liang-Barsky line clipping algorithm
-bool liangBarskyClip(float &x1, float &y1, float &x2, float &y2)
+// Clip one line set against many windows; out[w] receives the survivors of windows[w] in
+// input order. What depends only on the line is set up once: dx and dy, which boundary of
+// each axis the line enters and which it leaves (from their signs), and the outcodes of
+// both endpoints as bit-planes over the windows, bit w of a plane being that code bit for
+// window w. Lines beyond one boundary of a window are dropped by the planes before any
+// division, and windows containing the whole line take it without any. With AVX2 the
+// windows are broadcast over the lanes 8 at a time. The ratios are the ones
+// liangBarskyClip computes, so out[w] matches clipping against windows[w] alone
+void liangBarskyClipWindows(const LineBatch &in, const std::vector<ClipRect> &windows, std::vector<LineBatch> &out)
 {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-
-    float p[4], q[4];
-    float u1 = 0.0f, u2 = 1.0f;
-
-    // Define p and q arrays for the four boundaries
-    p[0] = -dx;
-    q[0] = x1 - xMin; // Left
-    p[1] = dx;
-    q[1] = xMax - x1; // Right
-    p[2] = -dy;
-    q[2] = y1 - yMin; // Bottom
-    p[3] = dy;
-    q[3] = yMax - y1; // Top
-
-    // Check each boundary
-    for (int i = 0; i < 4; i++)
-    {
-        if (p[i] == 0)
+    size_t windowCount = windows.size();
+    out.resize(windowCount);
+    for (LineBatch &batch : out)
+        batch.clear();
+    if (windowCount == 0)
+        return;
+
+    // Window bounds as coordinate arrays, padded to whole vectors with windows never used
+    size_t groups = (windowCount + 7) / 8;
+    std::vector<float> wxMin(groups * 8, 0.0f), wyMin(groups * 8, 0.0f);
+    std::vector<float> wxMax(groups * 8, 0.0f), wyMax(groups * 8, 0.0f);
+    for (size_t w = 0; w < windowCount; w++)
+    {
+        wxMin[w] = windows[w].x0;
+        wyMin[w] = windows[w].y0;
+        wxMax[w] = windows[w].x1;
+        wyMax[w] = windows[w].y1;
+    }
+
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        float x1 = in.x1[i], y1 = in.y1[i], x2 = in.x2[i], y2 = in.y2[i];
+        float dx = x2 - x1, dy = y2 - y1;
+        float xEnd = x1 + dx, yEnd = y1 + dy; // Where u2 = 1 puts the second endpoint
+
+        for (size_t g = 0; g < groups; g++)
         {
-            // Line is parallel to boundary
-            if (q[i] < 0)
+            size_t base = g * 8;
+            int live = g + 1 < groups || windowCount % 8 == 0 ? 0xFF : (1 << windowCount % 8) - 1;
+#ifdef __AVX2__
+            __m256 vxMin = _mm256_loadu_ps(&wxMin[base]), vyMin = _mm256_loadu_ps(&wyMin[base]);
+            __m256 vxMax = _mm256_loadu_ps(&wxMax[base]), vyMax = _mm256_loadu_ps(&wyMax[base]);
+            __m256 vx1 = _mm256_set1_ps(x1), vy1 = _mm256_set1_ps(y1);
+            __m256 vx2 = _mm256_set1_ps(x2), vy2 = _mm256_set1_ps(y2);
+            auto plane = [](__m256 a, __m256 b)
+            { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); };
+            int left1 = plane(vx1, vxMin), left2 = plane(vx2, vxMin);
+            int right1 = plane(vxMax, vx1), right2 = plane(vxMax, vx2);
+            int bottom1 = plane(vy1, vyMin), bottom2 = plane(vy2, vyMin);
+            int top1 = plane(vyMax, vy1), top2 = plane(vyMax, vy2);
+#else
+            int left1 = 0, left2 = 0, right1 = 0, right2 = 0, bottom1 = 0, bottom2 = 0, top1 = 0, top2 = 0;
+            for (int lane = 0; lane < 8; lane++)
             {
-                // Line is outside boundary
-                return false;
+                size_t w = base + lane;
+                left1 |= (x1 < wxMin[w]) << lane;
+                left2 |= (x2 < wxMin[w]) << lane;
+                right1 |= (x1 > wxMax[w]) << lane;
+                right2 |= (x2 > wxMax[w]) << lane;
+                bottom1 |= (y1 < wyMin[w]) << lane;
+                bottom2 |= (y2 < wyMin[w]) << lane;
+                top1 |= (y1 > wyMax[w]) << lane;
+                top2 |= (y2 > wyMax[w]) << lane;
             }
-        }
-        else
-        {
-            float r = q[i] / p[i];
-
-            if (p[i] < 0)
+#endif
+            live &= ~((left1 & left2) | (right1 & right2) | (bottom1 & bottom2) | (top1 & top2));
+            if (live == 0)
+                continue;
+
+            int inside = live & ~(left1 | left2 | right1 | right2 | bottom1 | bottom2 | top1 | top2);
+            for (int mask = inside; mask; mask &= mask - 1)
+                out[base + countTrailingZeros(mask)].push(x1, y1, xEnd, yEnd);
+            int crossing = live & ~inside;
+            if (crossing == 0)
+                continue;
+
+            // Entering ratios raise u1, leaving ones lower u2; the ties keep the running value
+            // as std::max and std::min do. A zero dx or dy leaves nothing to do on that axis:
+            // lines outside such a boundary were already dropped by the planes
+#ifdef __AVX2__
+            __m256 u1 = _mm256_setzero_ps(), u2 = _mm256_set1_ps(1.0f);
+            auto axis = [&](float d, __m256 qLow, __m256 qHigh)
+            {
+                if (d == 0.0f)
+                    return;
+                __m256 rLow = _mm256_div_ps(qLow, _mm256_set1_ps(-d)), rHigh = _mm256_div_ps(qHigh, _mm256_set1_ps(d));
+                u1 = _mm256_max_ps(d > 0.0f ? rLow : rHigh, u1);
+                u2 = _mm256_min_ps(d > 0.0f ? rHigh : rLow, u2);
+            };
+            axis(dx, _mm256_sub_ps(vx1, vxMin), _mm256_sub_ps(vxMax, vx1));
+            axis(dy, _mm256_sub_ps(vy1, vyMin), _mm256_sub_ps(vyMax, vy1));
+            crossing &= _mm256_movemask_ps(_mm256_cmp_ps(u1, u2, _CMP_LE_OQ));
+            if (crossing == 0)
+                continue;
+
+            __m256 vdx = _mm256_set1_ps(dx), vdy = _mm256_set1_ps(dy);
+            alignas(32) float cx1[8], cy1[8], cx2[8], cy2[8];
+            _mm256_store_ps(cx1, _mm256_add_ps(vx1, _mm256_mul_ps(u1, vdx)));
+            _mm256_store_ps(cy1, _mm256_add_ps(vy1, _mm256_mul_ps(u1, vdy)));
+            _mm256_store_ps(cx2, _mm256_add_ps(vx1, _mm256_mul_ps(u2, vdx)));
+            _mm256_store_ps(cy2, _mm256_add_ps(vy1, _mm256_mul_ps(u2, vdy)));
+            for (int mask = crossing; mask; mask &= mask - 1)
             {
-                // Line enters the boundary (potentially entering)
-                u1 = std::max(u1, r);
+                int lane = countTrailingZeros(mask);
+                out[base + lane].push(cx1[lane], cy1[lane], cx2[lane], cy2[lane]);
             }
-            else
+#else
+            for (int mask = crossing; mask; mask &= mask - 1)
             {
-                // Line exits the boundary (potentially leaving)
-                u2 = std::min(u2, r);
+                size_t w = base + countTrailingZeros(mask);
+                float u1 = 0.0f, u2 = 1.0f;
+                auto axis = [&](float d, float qLow, float qHigh)
+                {
+                    if (d == 0.0f)
+                        return;
+                    float rLow = qLow / -d, rHigh = qHigh / d;
+                    u1 = std::max(u1, d > 0.0f ? rLow : rHigh);
+                    u2 = std::min(u2, d > 0.0f ? rHigh : rLow);
+                };
+                axis(dx, x1 - wxMin[w], wxMax[w] - x1);
+                axis(dy, y1 - wyMin[w], wyMax[w] - y1);
+                if (u1 <= u2)
+                    out[w].push(x1 + u1 * dx, y1 + u1 * dy, x1 + u2 * dx, y1 + u2 * dy);
             }
+#endif
         }
     }
+}
+
+// Headless comparison of clipping a layer into a grid of tiles one window at a time, with
+// liangBarskyClip and with the batch clipper, against liangBarskyClipWindows
+void benchmarkClipWindows(size_t n, int tilesPerSide)
+{
+    typedef std::chrono::steady_clock Clock;
 
-    // Check if line is clipped out
-    if (u1 > u2)
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f), offset(-0.3f, 0.3f);
+    LineBatch in;
+    for (size_t i = 0; i < n; i++)
     {
-        return false;
+        float x = position(rng), y = position(rng);
+        in.push(x, y, x + offset(rng), i % 16 == 0 ? y : y + offset(rng));
     }
 
-    // Calculate clipped coordinates
-    float clippedX1 = x1 + u1 * dx;
-    float clippedY1 = y1 + u1 * dy;
-    float clippedX2 = x1 + u2 * dx;
-    float clippedY2 = y1 + u2 * dy;
+    std::vector<ClipRect> tiles;
+    float size = 2.0f / tilesPerSide;
+    for (int r = 0; r < tilesPerSide; r++)
+        for (int c = 0; c < tilesPerSide; c++)
+            tiles.push_back({-1.0f + c * size, -1.0f + r * size, -1.0f + (c + 1) * size, -1.0f + (r + 1) * size});
 
-    x1 = clippedX1;
-    y1 = clippedY1;
-    x2 = clippedX2;
-    y2 = clippedY2;
+    float saved[4] = {xMin, yMin, xMax, yMax};
+    std::vector<LineBatch> serialOut(tiles.size()), batchOut(tiles.size()), windowsOut;
+    double serialMs = 1e30, batchMs = 1e30, windowsMs = 1e30;
+    for (int run = 0; run < 3; run++)
+    {
+        auto t0 = Clock::now();
+        for (size_t w = 0; w < tiles.size(); w++)
+        {
+            xMin = tiles[w].x0;
+            yMin = tiles[w].y0;
+            xMax = tiles[w].x1;
+            yMax = tiles[w].y1;
+            serialOut[w].clear();
+            for (size_t i = 0; i < n; i++)
+            {
+                float x1 = in.x1[i], y1 = in.y1[i], x2 = in.x2[i], y2 = in.y2[i];
+                if (liangBarskyClip(x1, y1, x2, y2))
+                    serialOut[w].push(x1, y1, x2, y2);
+            }
+        }
+        auto t1 = Clock::now();
+        for (size_t w = 0; w < tiles.size(); w++)
+        {
+            xMin = tiles[w].x0;
+            yMin = tiles[w].y0;
+            xMax = tiles[w].x1;
+            yMax = tiles[w].y1;
+            liangBarskyClipBatch(in, batchOut[w]);
+        }
+        auto t2 = Clock::now();
+        liangBarskyClipWindows(in, tiles, windowsOut);
+        auto t3 = Clock::now();
+        serialMs = std::min(serialMs, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        batchMs = std::min(batchMs, std::chrono::duration<double, std::milli>(t2 - t1).count());
+        windowsMs = std::min(windowsMs, std::chrono::duration<double, std::milli>(t3 - t2).count());
+    }
+    xMin = saved[0];
+    yMin = saved[1];
+    xMax = saved[2];
+    yMax = saved[3];
+
+    size_t total = 0, differing = 0;
+    float maxError = 0.0f;
+    for (size_t w = 0; w < tiles.size(); w++)
+    {
+        const LineBatch &a = serialOut[w], &b = windowsOut[w];
+        total += b.size();
+        if (a.size() != b.size())
+        {
+            differing++;
+            continue;
+        }
+        for (size_t i = 0; i < a.size(); i++)
+            maxError = std::max({maxError, std::fabs(a.x1[i] - b.x1[i]), std::fabs(a.y1[i] - b.y1[i]),
+                                 std::fabs(a.x2[i] - b.x2[i]), std::fabs(a.y2[i] - b.y2[i])});
+    }
 
-    return true;
+    std::cout << "Clipping " << n << " segments into " << tiles.size() << " tiles (" << total << " pieces)\n";
+    std::cout << "  liangBarskyClip per tile      : " << serialMs << " ms\n";
+    std::cout << "  liangBarskyClipBatch per tile : " << batchMs << " ms\n";
+    std::cout << "  liangBarskyClipWindows        : " << windowsMs << " ms\n";
+    if (differing == 0)
+        std::cout << "  Same pieces in every tile, max difference " << maxError << "\n";
+    else
+        std::cout << "  Piece counts DIFFER in " << differing << " tiles\n";
 }
 
 void display()
@@ -104,36 +409,19 @@ void display()
     // Draw original lines in red (solid)
     glLineWidth(2.5f);
     glColor3f(1.0f, 0.3f, 0.3f);
-    for (const auto &line : lines)
-    {
-        glBegin(GL_LINES);
-        glVertex2f(line.p1.x, line.p1.y);
-        glVertex2f(line.p2.x, line.p2.y);
-        glEnd();
-    }
+    drawLineSet(lines);
     // Draw clipped lines in green
     glColor3f(0.2f, 1.0f, 0.4f);
     glLineWidth(2.5f);
-    for (const auto &line : lines)
-    {
-        float x1 = line.p1.x, y1 = line.p1.y;
-        float x2 = line.p2.x, y2 = line.p2.y;
-
-        if (liangBarskyClip(x1, y1, x2, y2))
-        {
-            glBegin(GL_LINES);
-            glVertex2f(x1, y1);
-            glVertex2f(x2, y2);
-            glEnd();
-
-            // Draw endpoints
-            glPointSize(6.0f);
-            glBegin(GL_POINTS);
-            glVertex2f(x1, y1);
-            glVertex2f(x2, y2);
-            glEnd();
-        }
-    }
+    updateClipCache(clipCache, lines, linesVersion, clipKernel);
+    if (clipCache.reclipped > 0 || clipCache.candidates > 0)
+        std::cout << "Re-clipped " << clipCache.reclipped << " of " << lines.size() << " lines ("
+                  << clipCache.candidates << " looked at for the window move, " << clipCache.gridMs
+                  << " ms building the grid)\n";
+
+    // Clipped lines and their endpoints
+    glPointSize(6.0f);
+    drawClipCache(clipCache, true);
     glLineWidth(1.0f);
 
     glFlush();
@@ -171,10 +459,43 @@ void keyboard(unsigned char key, int x, int y)
     { // ESC key
         exit(0);
     }
+    if (key == 'n' || key == 'N')
+    {
+        appendRandomLines(lines, 1000, lineSeed);
+        std::cout << lines.size() << " lines\n";
+        glutPostRedisplay();
+    }
+    if ((key == 'e' || key == 'E') && !lines.empty())
+    {
+        // Move one line elsewhere; the cache re-clips only that line
+        std::vector<Line> moved;
+        appendRandomLines(moved, 1, lineSeed);
+        size_t i = lineSeed % lines.size();
+        lines[i] = moved[0];
+        invalidateLine(clipCache, i);
+        glutPostRedisplay();
+    }
+    if (key == 'k' || key == 'K')
+    {
+        clipKernel = nextKernel(clipKernel);
+        std::cout << "Clipping with " << kernelName(clipKernel) << "\n";
+        glutPostRedisplay();
+    }
 }
 
 int main(int argc, char **argv)
 {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        benchmarkClipBatch(4000000);
+        benchmarkClipEngine(4000000);
+        benchmarkKernels(2000000);
+        benchmarkLineGrid(4000000, KERNEL_LIANG_BARSKY);
+        benchmarkWindowDrag(4000000, KERNEL_LIANG_BARSKY);
+        benchmarkClipWindows(1000000, 8);
+        return 0;
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(900, 600);
@@ -217,10 +538,16 @@ int main(int argc, char **argv)
     std::cout << "  Red lines: Original lines\n";
     std::cout << "  Green lines: Clipped result\n";
     std::cout << "  Green dots: Clipped endpoints\n";
-    std::cout << "\nPress ESC to exit\n";
+    std::cout << "\nPress K to cycle through Liang-Barsky, Nicholl-Lee-Nicholl and Cohen-Sutherland\n";
+    std::cout << "Drag the window to move it, drag an edge or corner to resize it\n";
+    std::cout << "Press N to add 1000 random lines\n";
+    std::cout << "Press E to move a random line\n";
+    std::cout << "Press ESC to exit\n";
 
     glutDisplayFunc(display);
     glutKeyboardFunc(keyboard);
+    glutMouseFunc(clipWindowMouse);
+    glutMotionFunc(clipWindowMotion);
 
     glutMainLoop();
     return 0;
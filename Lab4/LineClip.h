@@ -0,0 +1,331 @@
+#ifndef LINECLIP_H
+#define LINECLIP_H
+
+// Clip window, line types and the scalar clipping kernels shared by the Lab4 line clippers
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit of a lane mask; mask must not be 0
+inline int countTrailingZeros(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// Region codes for Cohen-Sutherland algorithm
+const int INSIDE = 0; // 0000
+const int LEFT = 1;   // 0001
+const int RIGHT = 2;  // 0010
+const int BOTTOM = 4; // 0100
+const int TOP = 8;    // 1000
+
+// Clipping window boundaries
+inline float xMin = -0.5f, yMin = -0.5f;
+inline float xMax = 0.5f, yMax = 0.5f;
+inline unsigned windowVersion = 0; // Bumped after every change of the window
+
+struct Point
+{
+    float x, y;
+    Point(float px = 0, float py = 0) : x(px), y(py) {}
+};
+
+struct Line
+{
+    Point p1, p2;
+    Line(Point a = Point(), Point b = Point()) : p1(a), p2(b) {}
+};
+
+// Lines as separate coordinate arrays, the layout the batched clippers read 8 at a time
+struct LineBatch
+{
+    std::vector<float> x1, y1, x2, y2;
+
+    size_t size() const { return x1.size(); }
+
+    void push(float ax, float ay, float bx, float by)
+    {
+        x1.push_back(ax);
+        y1.push_back(ay);
+        x2.push_back(bx);
+        y2.push_back(by);
+    }
+
+    void resize(size_t n)
+    {
+        x1.resize(n);
+        y1.resize(n);
+        x2.resize(n);
+        y2.resize(n);
+    }
+
+    void clear()
+    {
+        x1.clear();
+        y1.clear();
+        x2.clear();
+        y2.clear();
+    }
+};
+
+// Append count random lines with endpoints in [-extent, extent]^2 (a small LCG, so runs repeat)
+inline void appendRandomLines(std::vector<Line> &lines, size_t count, uint32_t &seed, float extent = 1.0f)
+{
+    auto next = [&seed, extent]()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return (static_cast<float>(seed >> 8) / 16777216.0f * 2.0f - 1.0f) * extent;
+    };
+    for (size_t i = 0; i < count; i++)
+    {
+        float x1 = next(), y1 = next(), x2 = next(), y2 = next();
+        lines.emplace_back(Point(x1, y1), Point(x2, y2));
+    }
+}
+
+// Compute region code for a point
+inline int computeCode(float x, float y)
+{
+    int code = INSIDE;
+
+    if (x < xMin)
+        code |= LEFT;
+    else if (x > xMax)
+        code |= RIGHT;
+    if (y < yMin)
+        code |= BOTTOM;
+    else if (y > yMax)
+        code |= TOP;
+
+    return code;
+}
+
+// Cohen-Sutherland line clipping algorithm, starting from known endpoint codes
+inline bool cohenSutherlandClip(float &x1, float &y1, float &x2, float &y2, int code1, int code2)
+{
+    bool accept = false;
+
+    while (true)
+    {
+        if ((code1 == 0) && (code2 == 0))
+        {
+            // Both points inside window
+            accept = true;
+            break;
+        }
+        else if (code1 & code2)
+        {
+            // Both points share an outside region - trivially reject
+            break;
+        }
+        else
+        {
+            // Line needs clipping
+            int codeOut;
+            float x, y;
+
+            // Pick a point outside the window
+            codeOut = (code1 != 0) ? code1 : code2;
+
+            // Find intersection point using line equation
+            // y = y1 + slope * (x - x1), x = x1 + (1/slope) * (y - y1)
+            if (codeOut & TOP)
+            {
+                x = x1 + (x2 - x1) * (yMax - y1) / (y2 - y1);
+                y = yMax;
+            }
+            else if (codeOut & BOTTOM)
+            {
+                x = x1 + (x2 - x1) * (yMin - y1) / (y2 - y1);
+                y = yMin;
+            }
+            else if (codeOut & RIGHT)
+            {
+                y = y1 + (y2 - y1) * (xMax - x1) / (x2 - x1);
+                x = xMax;
+            }
+            else // LEFT, the only bit left
+            {
+                y = y1 + (y2 - y1) * (xMin - x1) / (x2 - x1);
+                x = xMin;
+            }
+
+            // Replace point outside window with intersection point
+            if (codeOut == code1)
+            {
+                x1 = x;
+                y1 = y;
+                code1 = computeCode(x1, y1);
+            }
+            else
+            {
+                x2 = x;
+                y2 = y;
+                code2 = computeCode(x2, y2);
+            }
+        }
+    }
+
+    return accept;
+}
+
+inline bool cohenSutherlandClip(float &x1, float &y1, float &x2, float &y2)
+{
+    return cohenSutherlandClip(x1, y1, x2, y2, computeCode(x1, y1), computeCode(x2, y2));
+}
+
+// Liang-Barsky line clipping algorithm
+inline bool liangBarskyClip(float &x1, float &y1, float &x2, float &y2)
+{
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+
+    float p[4], q[4];
+    float u1 = 0.0f, u2 = 1.0f;
+
+    // Define p and q arrays for the four boundaries
+    p[0] = -dx;
+    q[0] = x1 - xMin; // Left
+    p[1] = dx;
+    q[1] = xMax - x1; // Right
+    p[2] = -dy;
+    q[2] = y1 - yMin; // Bottom
+    p[3] = dy;
+    q[3] = yMax - y1; // Top
+
+    // Check each boundary
+    for (int i = 0; i < 4; i++)
+    {
+        if (p[i] == 0)
+        {
+            // Line is parallel to boundary
+            if (q[i] < 0)
+            {
+                // Line is outside boundary
+                return false;
+            }
+        }
+        else
+        {
+            float r = q[i] / p[i];
+
+            if (p[i] < 0)
+            {
+                // Line enters the boundary (potentially entering)
+                u1 = std::max(u1, r);
+            }
+            else
+            {
+                // Line exits the boundary (potentially leaving)
+                u2 = std::min(u2, r);
+            }
+        }
+    }
+
+    // Check if line is clipped out
+    if (u1 > u2)
+    {
+        return false;
+    }
+
+    // Calculate clipped coordinates
+    float clippedX1 = x1 + u1 * dx;
+    float clippedY1 = y1 + u1 * dy;
+    float clippedX2 = x1 + u2 * dx;
+    float clippedY2 = y1 + u2 * dy;
+
+    x1 = clippedX1;
+    y1 = clippedY1;
+    x2 = clippedX2;
+    y2 = clippedY2;
+
+    return true;
+}
+
+// Nicholl-Lee-Nicholl line clipping algorithm. The regions of both endpoints decide
+// everything up front: an outside P1 enters through one boundary, chosen (at a corner) and
+// checked against the window's extent by comparing the line's direction with the
+// directions to the boundaries, multiplied out so no division is needed; an outside P2 is
+// left through one boundary, chosen the same way. Only then are the entry and exit points
+// computed, one intersection each, so a line costs at most two and a rejected one none
+inline bool nichollLeeNichollClip(float &x1, float &y1, float &x2, float &y2)
+{
+    int code1 = computeCode(x1, y1), code2 = computeCode(x2, y2);
+    if ((code1 | code2) == 0)
+        return true;
+    if (code1 & code2)
+        return false;
+
+    float dx = x2 - x1, dy = y2 - y1;
+    float adx = std::fabs(dx), ady = std::fabs(dy);
+
+    // Boundaries a line moving along (dx, dy) crosses into and out of the window
+    float xIn = dx > 0 ? xMin : xMax, xOut = dx > 0 ? xMax : xMin;
+    float yIn = dy > 0 ? yMin : yMax, yOut = dy > 0 ? yMax : yMin;
+
+    float ex1 = x1, ey1 = y1, ex2 = x2, ey2 = y2;
+    if (code1)
+    {
+        // A line from a corner region enters through the boundary it reaches last
+        bool throughX = (code1 & (LEFT | RIGHT)) != 0;
+        if (throughX && (code1 & (BOTTOM | TOP)))
+            throughX = std::fabs(xIn - x1) * ady >= std::fabs(yIn - y1) * adx;
+
+        if (throughX)
+        {
+            // Where it meets x = xIn, scaled by |dx|, has to be within [yMin, yMax]
+            float rise = dy * std::fabs(xIn - x1);
+            if (rise < (yMin - y1) * adx || rise > (yMax - y1) * adx)
+                return false;
+            ex1 = xIn;
+            ey1 = std::min(yMax, std::max(yMin, y1 + dy * (xIn - x1) / dx));
+        }
+        else
+        {
+            float run = dx * std::fabs(yIn - y1);
+            if (run < (xMin - x1) * ady || run > (xMax - x1) * ady)
+                return false;
+            ex1 = std::min(xMax, std::max(xMin, x1 + dx * (yIn - y1) / dy));
+            ey1 = yIn;
+        }
+    }
+
+    if (code2)
+    {
+        // And leaves through the boundary it reaches first
+        bool throughX = (code2 & (LEFT | RIGHT)) != 0;
+        if (throughX && (code2 & (BOTTOM | TOP)))
+            throughX = std::fabs(xOut - x1) * ady <= std::fabs(yOut - y1) * adx;
+
+        if (throughX)
+        {
+            ex2 = xOut;
+            ey2 = std::min(yMax, std::max(yMin, y1 + dy * (xOut - x1) / dx));
+        }
+        else
+        {
+            ex2 = std::min(xMax, std::max(xMin, x1 + dx * (yOut - y1) / dy));
+            ey2 = yOut;
+        }
+    }
+
+    x1 = ex1;
+    y1 = ey1;
+    x2 = ex2;
+    y2 = ey2;
+    return true;
+}
+
+#endif
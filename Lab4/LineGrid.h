@@ -0,0 +1,328 @@
+#ifndef LINEGRID_H
+#define LINEGRID_H
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <tuple>
+
+#include "ClipEngine.h"
+
+// Uniform grid over a line set, built once. Every line is listed in each cell its bounding
+// box overlaps. A line whose box falls within a single cell is "local" to it and listed
+// before the cell's spanning lines, and each cell keeps the bounds of its local lines.
+// A window query then visits only the cells it overlaps:
+//   - local lines of a cell whose local bounds lie inside the window are accepted untested,
+//   - all other lines of visited cells go through the clipping kernel (spanning lines once),
+//   - lines of cells the window does not touch are never looked at
+struct LineGrid
+{
+    float x0 = 0.0f, y0 = 0.0f;       // Lower left corner of the grid
+    float cellW = 1.0f, cellH = 1.0f; // Cell size
+    int cols = 0, rows = 0;
+
+    // Cell c lists cellLines[cellStart[c] .. cellStart[c + 1]), local lines up to localEnd[c]
+    std::vector<uint32_t> cellStart, localEnd, cellLines;
+    std::vector<float> localBounds; // xMin, yMin, xMax, yMax of the local lines of each cell
+
+    // Query stamp per line, so a spanning line is clipped once per query
+    std::vector<uint32_t> stamp;
+    uint32_t query = 0;
+};
+
+struct GridQueryStats
+{
+    size_t cellsVisited = 0;
+    size_t cellsCovered = 0;     // Visited cells whose local lines were accepted untested
+    size_t acceptedUntested = 0; // Lines output without running the kernel
+    size_t tested = 0;           // Lines that went through the kernel
+};
+
+inline int gridColumn(const LineGrid &grid, float x)
+{
+    return std::min(grid.cols - 1, std::max(0, static_cast<int>(std::floor((x - grid.x0) / grid.cellW))));
+}
+
+inline int gridRow(const LineGrid &grid, float y)
+{
+    return std::min(grid.rows - 1, std::max(0, static_cast<int>(std::floor((y - grid.y0) / grid.cellH))));
+}
+
+// Build the grid over lines with side x side cells. 0 picks about 8 lines per cell, but no
+// cells narrower than twice the mean line extent, so most lines stay local to one cell
+inline void buildLineGrid(LineGrid &grid, const std::vector<Line> &lines, int side = 0)
+{
+    float bx0 = 1e30f, by0 = 1e30f, bx1 = -1e30f, by1 = -1e30f;
+    double extent = 0.0;
+    for (const Line &l : lines)
+    {
+        bx0 = std::min({bx0, l.p1.x, l.p2.x});
+        by0 = std::min({by0, l.p1.y, l.p2.y});
+        bx1 = std::max({bx1, l.p1.x, l.p2.x});
+        by1 = std::max({by1, l.p1.y, l.p2.y});
+        extent += std::max(std::fabs(l.p2.x - l.p1.x), std::fabs(l.p2.y - l.p1.y));
+    }
+    if (lines.empty())
+        bx0 = by0 = 0.0f, bx1 = by1 = 1.0f;
+
+    if (side <= 0)
+    {
+        double bySize = std::sqrt(lines.size() / 8.0);
+        if (extent > 0.0)
+            bySize = std::min(bySize, std::max(bx1 - bx0, by1 - by0) / (2.0 * extent / lines.size()));
+        side = std::max(1, std::min(1024, static_cast<int>(bySize)));
+    }
+
+    grid.cols = grid.rows = side;
+    grid.x0 = bx0;
+    grid.y0 = by0;
+    grid.cellW = std::max(bx1 - bx0, 1e-6f) / side;
+    grid.cellH = std::max(by1 - by0, 1e-6f) / side;
+
+    size_t cells = static_cast<size_t>(side) * side;
+    std::vector<uint32_t> localCount(cells, 0), spanCount(cells, 0);
+    auto cellRange = [&grid](const Line &l, int &c0, int &r0, int &c1, int &r1)
+    {
+        c0 = gridColumn(grid, std::min(l.p1.x, l.p2.x));
+        c1 = gridColumn(grid, std::max(l.p1.x, l.p2.x));
+        r0 = gridRow(grid, std::min(l.p1.y, l.p2.y));
+        r1 = gridRow(grid, std::max(l.p1.y, l.p2.y));
+    };
+
+    // Count, prefix sum, then fill: local lines first in every cell
+    for (const Line &l : lines)
+    {
+        int c0, r0, c1, r1;
+        cellRange(l, c0, r0, c1, r1);
+        if (c0 == c1 && r0 == r1)
+        {
+            localCount[static_cast<size_t>(r0) * side + c0]++;
+            continue;
+        }
+        for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++)
+                spanCount[static_cast<size_t>(r) * side + c]++;
+    }
+
+    grid.cellStart.assign(cells + 1, 0);
+    grid.localEnd.resize(cells);
+    for (size_t c = 0; c < cells; c++)
+    {
+        grid.localEnd[c] = grid.cellStart[c] + localCount[c];
+        grid.cellStart[c + 1] = grid.localEnd[c] + spanCount[c];
+    }
+    grid.cellLines.resize(grid.cellStart[cells]);
+    grid.localBounds.assign(cells * 4, 0.0f);
+    for (size_t c = 0; c < cells; c++)
+    {
+        grid.localBounds[c * 4 + 0] = grid.localBounds[c * 4 + 1] = 1e30f;
+        grid.localBounds[c * 4 + 2] = grid.localBounds[c * 4 + 3] = -1e30f;
+    }
+
+    std::vector<uint32_t> nextLocal(grid.cellStart.begin(), grid.cellStart.end() - 1);
+    std::vector<uint32_t> nextSpan(grid.localEnd);
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        const Line &l = lines[i];
+        int c0, r0, c1, r1;
+        cellRange(l, c0, r0, c1, r1);
+        if (c0 == c1 && r0 == r1)
+        {
+            size_t c = static_cast<size_t>(r0) * side + c0;
+            grid.cellLines[nextLocal[c]++] = static_cast<uint32_t>(i);
+            float *b = &grid.localBounds[c * 4];
+            b[0] = std::min({b[0], l.p1.x, l.p2.x});
+            b[1] = std::min({b[1], l.p1.y, l.p2.y});
+            b[2] = std::max({b[2], l.p1.x, l.p2.x});
+            b[3] = std::max({b[3], l.p1.y, l.p2.y});
+            continue;
+        }
+        for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++)
+                grid.cellLines[nextSpan[static_cast<size_t>(r) * side + c]++] = static_cast<uint32_t>(i);
+    }
+
+    grid.stamp.assign(lines.size(), 0);
+    grid.query = 0;
+}
+
+// Start a query: lines stamped before it count as unvisited again
+inline void beginGridQuery(LineGrid &grid)
+{
+    if (++grid.query == 0)
+    {
+        std::fill(grid.stamp.begin(), grid.stamp.end(), 0);
+        grid.query = 1;
+    }
+}
+
+// Call fn(i) for every line listed in a cell overlapping [rx0, rx1] x [ry0, ry1] that the
+// current query has not visited yet. This is a superset of the lines whose bounding boxes
+// touch the rectangle
+template <typename Fn>
+void visitGridRect(LineGrid &grid, float rx0, float ry0, float rx1, float ry1, Fn fn)
+{
+    if (grid.cols == 0 || rx1 < grid.x0 || ry1 < grid.y0 || rx0 > grid.x0 + grid.cellW * grid.cols ||
+        ry0 > grid.y0 + grid.cellH * grid.rows)
+        return;
+
+    int c0 = gridColumn(grid, rx0), c1 = gridColumn(grid, rx1);
+    int r0 = gridRow(grid, ry0), r1 = gridRow(grid, ry1);
+    for (int r = r0; r <= r1; r++)
+    {
+        for (int c = c0; c <= c1; c++)
+        {
+            size_t cell = static_cast<size_t>(r) * grid.cols + c;
+            for (uint32_t k = grid.cellStart[cell]; k < grid.cellStart[cell + 1]; k++)
+            {
+                uint32_t i = grid.cellLines[k];
+                if (grid.stamp[i] == grid.query)
+                    continue;
+                grid.stamp[i] = grid.query;
+                fn(i);
+            }
+        }
+    }
+}
+
+// Clip the lines indexed by grid against the current window; survivors are appended to out
+inline size_t clipLinesGrid(LineGrid &grid, const std::vector<Line> &lines, ClipKernel kernel,
+                            std::vector<Line> &out, GridQueryStats *stats = nullptr)
+{
+    GridQueryStats local;
+    out.clear();
+    beginGridQuery(grid);
+
+    // Nothing to visit when the window misses the grid altogether
+    if (xMax < grid.x0 || yMax < grid.y0 || xMin > grid.x0 + grid.cellW * grid.cols ||
+        yMin > grid.y0 + grid.cellH * grid.rows)
+    {
+        if (stats)
+            *stats = local;
+        return 0;
+    }
+
+    auto clipInto = [&](uint32_t i)
+    {
+        float x1 = lines[i].p1.x, y1 = lines[i].p1.y, x2 = lines[i].p2.x, y2 = lines[i].p2.y;
+        if (clipLine(kernel, x1, y1, x2, y2))
+            out.emplace_back(Point(x1, y1), Point(x2, y2));
+        local.tested++;
+    };
+
+    int c0 = gridColumn(grid, xMin), c1 = gridColumn(grid, xMax);
+    int r0 = gridRow(grid, yMin), r1 = gridRow(grid, yMax);
+    for (int r = r0; r <= r1; r++)
+    {
+        for (int c = c0; c <= c1; c++)
+        {
+            size_t cell = static_cast<size_t>(r) * grid.cols + c;
+            const float *b = &grid.localBounds[cell * 4];
+            local.cellsVisited++;
+
+            if (b[0] >= xMin && b[1] >= yMin && b[2] <= xMax && b[3] <= yMax)
+            {
+                local.cellsCovered++;
+                for (uint32_t k = grid.cellStart[cell]; k < grid.localEnd[cell]; k++)
+                    out.push_back(lines[grid.cellLines[k]]);
+                local.acceptedUntested += grid.localEnd[cell] - grid.cellStart[cell];
+            }
+            else
+            {
+                for (uint32_t k = grid.cellStart[cell]; k < grid.localEnd[cell]; k++)
+                    clipInto(grid.cellLines[k]);
+            }
+
+            for (uint32_t k = grid.localEnd[cell]; k < grid.cellStart[cell + 1]; k++)
+            {
+                uint32_t i = grid.cellLines[k];
+                if (grid.stamp[i] == grid.query)
+                    continue;
+                grid.stamp[i] = grid.query;
+                clipInto(i);
+            }
+        }
+    }
+
+    if (stats)
+        *stats = local;
+    return out.size();
+}
+
+// Short segments spread far beyond a small window, clipped by scanning every line and
+// through the grid; the outputs are compared as sets
+inline void benchmarkLineGrid(size_t n, ClipKernel kernel)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<Line> in;
+    in.reserve(n);
+    uint32_t seed = 99;
+    std::vector<Line> offsets;
+    appendRandomLines(in, n, seed, 10.0f);
+    appendRandomLines(offsets, n, seed, 0.05f);
+    for (size_t i = 0; i < n; i++)
+        in[i].p2 = Point(in[i].p1.x + offsets[i].p2.x, in[i].p1.y + offsets[i].p2.y);
+
+    LineGrid grid;
+    auto t0 = Clock::now();
+    buildLineGrid(grid, in);
+    auto t1 = Clock::now();
+    std::cout << "Grid of " << grid.cols << "x" << grid.rows << " cells over " << n << " lines, built in "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
+
+    for (float half : {0.5f, 2.0f})
+    {
+        xMin = yMin = -half;
+        xMax = yMax = half;
+        windowVersion++;
+
+        std::vector<Line> scanned, indexed;
+        GridQueryStats stats;
+        double scanMs = 1e30, gridMs = 1e30;
+        for (int run = 0; run < 5; run++)
+        {
+            auto t2 = Clock::now();
+            scanned.clear();
+            for (const Line &l : in)
+            {
+                float x1 = l.p1.x, y1 = l.p1.y, x2 = l.p2.x, y2 = l.p2.y;
+                if (clipLine(kernel, x1, y1, x2, y2))
+                    scanned.emplace_back(Point(x1, y1), Point(x2, y2));
+            }
+            auto t3 = Clock::now();
+            clipLinesGrid(grid, in, kernel, indexed, &stats);
+            auto t4 = Clock::now();
+            scanMs = std::min(scanMs, std::chrono::duration<double, std::milli>(t3 - t2).count());
+            gridMs = std::min(gridMs, std::chrono::duration<double, std::milli>(t4 - t3).count());
+        }
+
+        // Lines accepted untested keep their exact endpoints where a kernel may round
+        auto key = [](const Line &l)
+        { return std::make_tuple(l.p1.x, l.p1.y, l.p2.x, l.p2.y); };
+        auto byKey = [&key](const Line &a, const Line &b)
+        { return key(a) < key(b); };
+        std::sort(scanned.begin(), scanned.end(), byKey);
+        std::sort(indexed.begin(), indexed.end(), byKey);
+        float maxError = 0.0f;
+        bool same = scanned.size() == indexed.size();
+        for (size_t i = 0; same && i < scanned.size(); i++)
+            maxError = std::max({maxError, std::fabs(scanned[i].p1.x - indexed[i].p1.x), std::fabs(scanned[i].p1.y - indexed[i].p1.y),
+                                 std::fabs(scanned[i].p2.x - indexed[i].p2.x), std::fabs(scanned[i].p2.y - indexed[i].p2.y)});
+
+        std::cout << "  Window " << 2 * half << "x" << 2 * half << " (" << kernelName(kernel) << "): scan " << scanMs
+                  << " ms, grid " << gridMs << " ms, " << indexed.size() << " visible\n";
+        std::cout << "    " << stats.cellsVisited << " cells visited (" << stats.cellsCovered << " covered), "
+                  << stats.acceptedUntested << " accepted untested, " << stats.tested << " clipped, ";
+        if (same)
+            std::cout << "same output (max difference " << maxError << ")\n";
+        else
+            std::cout << "OUTPUT DIFFERS (" << scanned.size() << " scanned)\n";
+    }
+
+    xMin = yMin = -0.5f;
+    xMax = yMax = 0.5f;
+    windowVersion++;
+}
+
+#endif
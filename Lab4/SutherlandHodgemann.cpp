@@ -3,12 +3,35 @@
 #include <iostream>
 #include <cmath>
 #include <string>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <new>
+#include <cassert>
 
-struct Point
+#include "CyrusBeck.h"
+
+// Heap allocations made so far; every operator new in the program goes through the
+// replacements below, so --bench can show what a clip allocates
+size_t allocationCount = 0;
+
+void *operator new(size_t size)
 {
-    float x, y;
-    Point(float x = 0, float y = 0) : x(x), y(y) {}
-};
+    allocationCount++;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
 
 // Global variables
 std::vector<Point> subjectPolygon;
@@ -16,6 +39,12 @@ std::vector<Point> clipPolygon;
 std::vector<Point> clippedPolygon;
 bool showClipped = false;
 
+// Lines clipped against clipPolygon with Cyrus-Beck
+ConvexClipper clipper;
+std::vector<Line> probeLines;
+std::vector<Line> clippedProbeLines;
+bool showLines = false;
+
 // Check if point is inside edge (left side of the line from p1 to p2)
 bool inside(Point p, Point p1, Point p2)
 {
@@ -81,6 +110,181 @@ std::vector<Point> sutherlandHodgman(std::vector<Point> poly, std::vector<Point>
     return output;
 }
 
+// Sutherland-Hodgman without copies: the subject is read in place, and every clip edge
+// reads one of two scratch buffers and writes the other. The buffers belong to the
+// clipper and keep their capacity, so once they have grown to the largest result seen,
+// clipping allocates nothing. Each vertex is tested against an edge once, the previous
+// vertex's result being carried along
+struct PolygonClipper
+{
+    std::vector<Point> buffers[2];
+
+    explicit PolygonClipper(size_t vertices = 64)
+    {
+        buffers[0].reserve(vertices);
+        buffers[1].reserve(vertices);
+    }
+
+    // Whether p points into buffer b
+    bool inBuffer(const Point *p, int b) const
+    {
+        return !buffers[b].empty() && p >= buffers[b].data() && p < buffers[b].data() + buffers[b].size();
+    }
+
+    // Clip poly[0 .. polyCount) against the convex clipPoly[0 .. clipCount). The result
+    // lives in one of the buffers and stays valid until the next call. poly may be a
+    // previous result of this clipper (the passes then start in the other buffer, so it is
+    // read before being overwritten); clipPoly must not point into the clipper's buffers
+    const std::vector<Point> &clip(const Point *poly, size_t polyCount, const Point *clipPoly, size_t clipCount)
+    {
+        assert(!inBuffer(clipPoly, 0) && !inBuffer(clipPoly, 1));
+
+        int first = inBuffer(poly, 0) ? 1 : 0;
+        if (clipCount == 0 || polyCount == 0)
+        {
+            int own = inBuffer(poly, 0) ? 0 : (inBuffer(poly, 1) ? 1 : -1);
+            if (own < 0)
+            {
+                buffers[0].assign(poly, poly + polyCount);
+                return buffers[0];
+            }
+
+            // Already in a buffer: cut it down to poly[0 .. polyCount) in place
+            std::vector<Point> &buffer = buffers[own];
+            size_t offset = poly - buffer.data();
+            buffer.erase(buffer.begin() + offset + polyCount, buffer.end());
+            buffer.erase(buffer.begin(), buffer.begin() + offset);
+            return buffer;
+        }
+
+        const Point *input = poly;
+        size_t inputCount = polyCount;
+        std::vector<Point> *output = &buffers[first];
+
+        for (size_t i = 0; i < clipCount && inputCount > 0; i++)
+        {
+            output = &buffers[(first + i) & 1];
+            output->clear();
+
+            Point edgeStart = clipPoly[i];
+            Point edgeEnd = clipPoly[i + 1 == clipCount ? 0 : i + 1];
+
+            Point previous = input[inputCount - 1];
+            bool previousInside = inside(previous, edgeStart, edgeEnd);
+            for (size_t j = 0; j < inputCount; j++)
+            {
+                Point current = input[j];
+                bool currentInside = inside(current, edgeStart, edgeEnd);
+
+                if (currentInside != previousInside)
+                    output->push_back(intersection(previous, current, edgeStart, edgeEnd));
+                if (currentInside)
+                    output->push_back(current);
+
+                previous = current;
+                previousInside = currentInside;
+            }
+
+            input = output->data();
+            inputCount = output->size();
+        }
+        return *output;
+    }
+};
+
+PolygonClipper polygonClipper;
+
+// Clip random rotated star polygons against a rotated octagon, with sutherlandHodgman and
+// with a PolygonClipper, counting time and heap allocations after one warm-up clip
+void benchmarkPolygonClipper(size_t iterations)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<Point> octagon;
+    for (int k = 0; k < 8; k++)
+    {
+        float angle = 0.2f + k * 3.14159265f / 4.0f;
+        octagon.push_back(Point(180.0f * std::cos(angle), 180.0f * std::sin(angle)));
+    }
+
+    const int STAR_POINTS = 32;
+    std::vector<std::vector<Point>> subjects(64);
+    for (size_t s = 0; s < subjects.size(); s++)
+    {
+        for (int k = 0; k < 2 * STAR_POINTS; k++)
+        {
+            float angle = s * 0.1f + k * 3.14159265f / STAR_POINTS;
+            float radius = k % 2 ? 120.0f : 240.0f + s;
+            subjects[s].push_back(Point(radius * std::cos(angle) + s, radius * std::sin(angle) - s));
+        }
+    }
+
+    PolygonClipper clipper;
+    clipper.clip(subjects[0].data(), subjects[0].size(), octagon.data(), octagon.size());
+
+    size_t allocations = allocationCount;
+    size_t vertices = 0;
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < iterations; i++)
+    {
+        const std::vector<Point> &subject = subjects[i % subjects.size()];
+        vertices += sutherlandHodgman(subject, octagon).size();
+    }
+    auto t1 = Clock::now();
+    size_t copyingAllocations = allocationCount - allocations;
+
+    allocations = allocationCount;
+    size_t clipperVertices = 0;
+    auto t2 = Clock::now();
+    for (size_t i = 0; i < iterations; i++)
+    {
+        const std::vector<Point> &subject = subjects[i % subjects.size()];
+        clipperVertices += clipper.clip(subject.data(), subject.size(), octagon.data(), octagon.size()).size();
+    }
+    auto t3 = Clock::now();
+    size_t clipperAllocations = allocationCount - allocations;
+
+    // Both must produce the same vertices
+    bool same = vertices == clipperVertices;
+    for (size_t s = 0; same && s < subjects.size(); s++)
+    {
+        std::vector<Point> expected = sutherlandHodgman(subjects[s], octagon);
+        const std::vector<Point> &result = clipper.clip(subjects[s].data(), subjects[s].size(), octagon.data(), octagon.size());
+        same = expected.size() == result.size();
+        for (size_t k = 0; same && k < result.size(); k++)
+            same = expected[k].x == result[k].x && expected[k].y == result[k].y;
+
+        // Clip that result again, twice: the triangle leaves its result in the other
+        // buffer than the octagon does, so both buffers get passed back in
+        std::vector<Point> triangle = {Point(-200, -150), Point(200, -150), Point(0, 220)};
+        std::vector<Point> square = {Point(-100, -100), Point(100, -100), Point(100, 100), Point(-100, 100)};
+        std::vector<Point> twice = sutherlandHodgman(sutherlandHodgman(expected, triangle), square);
+        const std::vector<Point> &first = clipper.clip(result.data(), result.size(), triangle.data(), triangle.size());
+        const std::vector<Point> &again = clipper.clip(first.data(), first.size(), square.data(), square.size());
+        same = same && twice.size() == again.size();
+        for (size_t k = 0; same && k < again.size(); k++)
+            same = twice[k].x == again[k].x && twice[k].y == again[k].y;
+    }
+
+    std::cout << "Clipping " << iterations << " polygons of " << 2 * STAR_POINTS << " vertices against an octagon\n";
+    std::cout << "  sutherlandHodgman : " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms, "
+              << copyingAllocations << " allocations\n";
+    std::cout << "  PolygonClipper    : " << std::chrono::duration<double, std::milli>(t3 - t2).count() << " ms, "
+              << clipperAllocations << " allocations\n";
+    std::cout << "  Results " << (same ? "match" : "DIFFER") << "\n";
+}
+
+void clipProbeLines()
+{
+    clippedProbeLines.clear();
+    for (const Line &line : probeLines)
+    {
+        float x1 = line.p1.x, y1 = line.p1.y, x2 = line.p2.x, y2 = line.p2.y;
+        if (cyrusBeckClip(clipper, x1, y1, x2, y2))
+            clippedProbeLines.push_back(Line(Point(x1, y1), Point(x2, y2)));
+    }
+}
+
 void init()
 {
     glClearColor(0.05f, 0.05f, 0.12f, 1.0f);
@@ -107,6 +311,24 @@ void init()
     clipPolygon.push_back(Point(180, -160));
     clipPolygon.push_back(Point(180, 160));
     clipPolygon.push_back(Point(-180, 160));
+
+    uint32_t seed = 5;
+    appendRandomLines(probeLines, 30, seed, 350.0f);
+    buildConvexClipper(clipper, clipPolygon);
+    clipProbeLines();
+}
+
+void drawLines(const std::vector<Line> &lines, float r, float g, float b, float lineWidth)
+{
+    glLineWidth(lineWidth);
+    glColor3f(r, g, b);
+    glBegin(GL_LINES);
+    for (const auto &line : lines)
+    {
+        glVertex2f(line.p1.x, line.p1.y);
+        glVertex2f(line.p2.x, line.p2.y);
+    }
+    glEnd();
 }
 
 void drawPolygon(const std::vector<Point> &poly, float r, float g, float b, float a, float lineWidth, bool filled = false)
@@ -187,6 +409,12 @@ void display()
         drawPolygon(clippedPolygon, 0.3f, 1.0f, 0.5f, 1.0f, 3.0f, true);
     }
 
+    if (showLines)
+    {
+        drawLines(probeLines, 0.5f, 0.2f, 0.2f, 1.0f);
+        drawLines(clippedProbeLines, 1.0f, 0.4f, 0.4f, 2.5f);
+    }
+
     drawInstructions();
 
     glutSwapBuffers();
@@ -200,13 +428,19 @@ void keyboard(unsigned char key, int x, int y)
 
         if (showClipped)
         {
-            clippedPolygon = sutherlandHodgman(subjectPolygon, clipPolygon);
+            clippedPolygon = polygonClipper.clip(subjectPolygon.data(), subjectPolygon.size(),
+                                                 clipPolygon.data(), clipPolygon.size());
             std::cout << "\n=== CLIPPING PERFORMED ===\n";
             std::cout << "Original vertices: " << subjectPolygon.size() << "\n";
             std::cout << "Clipped vertices:  " << clippedPolygon.size() << "\n";
         }
         glutPostRedisplay();
     }
+    else if (key == 'l' || key == 'L')
+    {
+        showLines = !showLines;
+        glutPostRedisplay();
+    }
     else if (key == 27)
     {
         exit(0);
@@ -215,6 +449,13 @@ void keyboard(unsigned char key, int x, int y)
 
 int main(int argc, char **argv)
 {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+    {
+        benchmarkCyrusBeck(4000000);
+        benchmarkPolygonClipper(200000);
+        return 0;
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_MULTISAMPLE);
     glutInitWindowSize(850, 650);
@@ -229,6 +470,7 @@ int main(int argc, char **argv)
     std::cout << "SUTHERLAND-HODGMAN POLYGON CLIPPING DEMO \n";
     std::cout << "Controls:\n";
     std::cout << "  [SPACE] - Toggle clipping visualization\n";
+    std::cout << "  [L]     - Toggle lines clipped by Cyrus-Beck\n";
     std::cout << "  [ESC]   - Exit program\n\n";
     std::cout << "Algorithm: Clips a polygon against a convex region\n";
     std::cout << "by iteratively clipping against each edge.\n\n";
@@ -0,0 +1,81 @@
+#ifndef WINDOWDRAG_H
+#define WINDOWDRAG_H
+
+#include <GL/glut.h>
+#include <cmath>
+
+#include "LineClip.h"
+
+// Mouse editing of the clip window. Pressing the left button near an edge or corner grabs
+// it and dragging resizes the window; pressing inside grabs all four edges, so the window
+// moves. Grabbed edges are kept as region codes. Every change bumps windowVersion, which
+// the clip cache turns into an incremental re-clip
+const float GRAB_DISTANCE = 0.03f;   // How close to an edge a press grabs it
+const float MIN_WINDOW_SIZE = 0.05f; // Resizing never makes the window smaller than this
+
+inline int dragEdges = 0;
+inline float dragX = 0.0f, dragY = 0.0f;
+
+// Window pixel to world coordinates under gluOrtho2D(-1, 1, -1, 1)
+inline void mouseToWorld(int px, int py, float &x, float &y)
+{
+    x = 2.0f * px / glutGet(GLUT_WINDOW_WIDTH) - 1.0f;
+    y = 1.0f - 2.0f * py / glutGet(GLUT_WINDOW_HEIGHT);
+}
+
+inline void clipWindowMouse(int button, int state, int px, int py)
+{
+    if (button != GLUT_LEFT_BUTTON)
+        return;
+    if (state == GLUT_UP)
+    {
+        dragEdges = 0;
+        return;
+    }
+
+    float x, y;
+    mouseToWorld(px, py, x, y);
+    bool alongX = x > xMin - GRAB_DISTANCE && x < xMax + GRAB_DISTANCE;
+    bool alongY = y > yMin - GRAB_DISTANCE && y < yMax + GRAB_DISTANCE;
+
+    dragEdges = 0;
+    if (alongY && std::fabs(x - xMin) < GRAB_DISTANCE)
+        dragEdges |= LEFT;
+    else if (alongY && std::fabs(x - xMax) < GRAB_DISTANCE)
+        dragEdges |= RIGHT;
+    if (alongX && std::fabs(y - yMin) < GRAB_DISTANCE)
+        dragEdges |= BOTTOM;
+    else if (alongX && std::fabs(y - yMax) < GRAB_DISTANCE)
+        dragEdges |= TOP;
+    if (dragEdges == 0 && x > xMin && x < xMax && y > yMin && y < yMax)
+        dragEdges = LEFT | RIGHT | BOTTOM | TOP;
+
+    dragX = x;
+    dragY = y;
+}
+
+inline void clipWindowMotion(int px, int py)
+{
+    if (dragEdges == 0)
+        return;
+
+    float x, y;
+    mouseToWorld(px, py, x, y);
+    float dx = x - dragX, dy = y - dragY;
+    dragX = x;
+    dragY = y;
+
+    if (dragEdges & LEFT)
+        xMin = (dragEdges & RIGHT) ? xMin + dx : std::min(xMin + dx, xMax - MIN_WINDOW_SIZE);
+    if (dragEdges & RIGHT)
+        xMax = (dragEdges & LEFT) ? xMax + dx : std::max(xMax + dx, xMin + MIN_WINDOW_SIZE);
+    if (dragEdges & BOTTOM)
+        yMin = (dragEdges & TOP) ? yMin + dy : std::min(yMin + dy, yMax - MIN_WINDOW_SIZE);
+    if (dragEdges & TOP)
+        yMax = (dragEdges & BOTTOM) ? yMax + dy : std::max(yMax + dy, yMin + MIN_WINDOW_SIZE);
+
+    windowVersion++;
+    glutPostRedisplay();
+}
+
+#endif